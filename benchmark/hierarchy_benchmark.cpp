@@ -0,0 +1,95 @@
+/**
+ * @file hierarchy_benchmark.cpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief World transform propagation through deep and wide hierarchies of 100k nodes.
+ * @version 0.1
+ * @date 2024-08-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "scene/component.hpp"
+#include "scene/scene.hpp"
+
+using namespace MEngine;
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_ms(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Build `node_count` nodes where each new node is attached below `pick_parent(i, nodes)`.
+ *
+ */
+static void run(const char *name, size_t node_count,
+                const std::function<size_t(size_t, const std::vector<Entity> &)> &pick_parent) {
+  Scene               scene;
+  std::vector<Entity> nodes;
+  nodes.reserve(node_count);
+
+  auto start = Clock::now();
+  nodes.push_back(scene.CreateEntity("root"));
+  nodes.back().AddComponent<Transform>();
+  for (size_t i = 1; i < node_count; i++) {
+    Entity node = scene.CreateEntity();
+    node.AddComponent<Transform>(glm::vec3(1.0f, 0.0f, 0.0f));
+    scene.SetParent(node, nodes[pick_parent(i, nodes)]);
+    nodes.push_back(node);
+  }
+  double build_ms = elapsed_ms(start);
+
+  // First update sorts the hierarchy and computes every world matrix.
+  start = Clock::now();
+  scene.UpdateTransforms();
+  double initial_ms = elapsed_ms(start);
+
+  // Nothing changed: should be close to free.
+  start = Clock::now();
+  scene.UpdateTransforms();
+  double idle_ms = elapsed_ms(start);
+
+  // Moving the root dirties the whole tree through one linear pass.
+  const int frames = 20;
+  start            = Clock::now();
+  for (int frame = 0; frame < frames; frame++) {
+    nodes[0].Patch<Transform>([frame](auto &transform) { transform.rotation.z = 0.01f * frame; });
+    scene.UpdateTransforms();
+  }
+  double root_ms = elapsed_ms(start) / frames;
+
+  // Moving one leaf only touches that leaf.
+  start = Clock::now();
+  for (int frame = 0; frame < frames; frame++) {
+    nodes.back().Patch<Transform>([frame](auto &transform) { transform.translation.y = 0.01f * frame; });
+    scene.UpdateTransforms();
+  }
+  double leaf_ms = elapsed_ms(start) / frames;
+
+  std::printf("%-5s %zu nodes | build %8.2f ms | initial %7.2f ms | idle %6.3f ms | root moved %7.2f ms | "
+              "leaf moved %6.3f ms\n",
+              name, node_count, build_ms, initial_ms, idle_ms, root_ms, leaf_ms);
+}
+
+int main() {
+  const size_t node_count = 100000;
+
+  // A single chain, every node is the child of the previous one.
+  run("deep", node_count, [](size_t i, const std::vector<Entity> &) { return i - 1; });
+
+  // Every node directly below the root.
+  run("wide", node_count, [](size_t, const std::vector<Entity> &) { return size_t(0); });
+
+  // Balanced tree with 8 children per node.
+  run("tree", node_count, [](size_t i, const std::vector<Entity> &) { return (i - 1) / 8; });
+
+  return 0;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file job_system_benchmark.cpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief Scheduling overhead of the JobSystem, ParallelFor speedup and per-thread utilization.
+ * @version 0.1
+ * @date 2024-08-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "core/job_system.hpp"
+
+using namespace MEngine;
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_ms(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Cost of queueing, stealing and retiring jobs that do nothing.
+ *
+ */
+static void empty_jobs(size_t count) {
+  JobSystem         &jobs = JobSystem::Get();
+  JobSystem::Counter counter;
+
+  auto start = Clock::now();
+  for (size_t i = 0; i < count; i++) {
+    jobs.Run("Empty", [] {}, &counter);
+  }
+  jobs.Wait(counter);
+  double ms = elapsed_ms(start);
+
+  std::printf("%8zu empty jobs      | %8.3f ms | %6.1f ns/job\n", count, ms, ms * 1e6 / count);
+}
+
+/**
+ * @brief A chain where every job waits on the previous one, nothing can run in parallel.
+ *
+ */
+static void dependency_chain(size_t length) {
+  JobSystem                      &jobs = JobSystem::Get();
+  std::vector<JobSystem::Counter> counters(length);
+
+  auto start = Clock::now();
+  for (size_t i = 0; i < length; i++) {
+    jobs.Run("Chain", [] {}, &counters[i], i > 0 ? &counters[i - 1] : nullptr);
+  }
+  jobs.Wait(counters.back());
+  double ms = elapsed_ms(start);
+
+  std::printf("%8zu chained jobs    | %8.3f ms | %6.1f ns/job\n", length, ms, ms * 1e6 / length);
+}
+
+// Enough math per item that the loop is compute bound, similar to a sprite or particle update.
+static void transform(const float *in, float *out, size_t begin, size_t end) {
+  for (size_t i = begin; i < end; i++) {
+    float x = in[i];
+    out[i]  = std::sin(x) * std::cos(x * 0.5f) + std::sqrt(x + 1.0f);
+  }
+}
+
+static void parallel_for(size_t count, size_t min_batch) {
+  JobSystem &jobs = JobSystem::Get();
+
+  std::vector<float> in(count), out(count);
+  for (size_t i = 0; i < count; i++) {
+    in[i] = static_cast<float>(i % 1024) * 0.01f;
+  }
+
+  const int passes = 20;
+
+  auto start = Clock::now();
+  for (int pass = 0; pass < passes; pass++) {
+    transform(in.data(), out.data(), 0, count);
+  }
+  double serial_ms = elapsed_ms(start) / passes;
+
+  jobs.ResetStats();
+  start = Clock::now();
+  for (int pass = 0; pass < passes; pass++) {
+    jobs.ParallelFor("Transform", count, min_batch,
+                     [&](size_t begin, size_t end) { transform(in.data(), out.data(), begin, end); });
+  }
+  double parallel_ms = elapsed_ms(start) / passes;
+  double wall_ns     = parallel_ms * passes * 1e6;
+
+  std::printf("%8zu items batch %5zu | serial %8.3f ms | parallel %8.3f ms | %5.2fx on %u threads\n", count,
+              min_batch, serial_ms, parallel_ms, serial_ms / parallel_ms, jobs.GetThreadCount());
+
+  // The calling thread runs chunk 0 inline, so its job count only covers what it helped with while waiting.
+  auto stats = jobs.GetStats();
+  for (size_t thread = 0; thread < stats.size(); thread++) {
+    std::printf("    thread %2zu | %6llu jobs | %6llu stolen | busy %5.1f%%\n", thread,
+                static_cast<unsigned long long>(stats[thread].jobs),
+                static_cast<unsigned long long>(stats[thread].stolen), 100.0 * stats[thread].busy_ns / wall_ns);
+  }
+}
+
+/**
+ * @brief Empty jobs again with a profile hook installed, the difference to empty_jobs() is the hook cost.
+ *
+ */
+static void profile_hook(size_t count) {
+  JobSystem &jobs = JobSystem::Get();
+
+  // Every thread only touches its own entry, foreign threads report an index past the pool and share the last one.
+  std::vector<uint64_t> events(jobs.GetThreadCount() + 1);
+  jobs.SetProfileHook([&events](const JobSystem::ProfileEvent &event) {
+    events[std::min<size_t>(event.thread, events.size() - 1)]++;
+  });
+
+  JobSystem::Counter counter;
+  auto               start = Clock::now();
+  for (size_t i = 0; i < count; i++) {
+    jobs.Run("Profiled", [] {}, &counter);
+  }
+  jobs.Wait(counter);
+  double ms = elapsed_ms(start);
+  jobs.SetProfileHook(nullptr);
+
+  std::printf("%8zu profiled jobs   | %8.3f ms | %6.1f ns/job |", count, ms, ms * 1e6 / count);
+  for (uint64_t thread_events : events) {
+    std::printf(" %llu", static_cast<unsigned long long>(thread_events));
+  }
+  std::printf(" events per thread\n");
+}
+
+int main() {
+  JobSystem::Get().Initialize();
+
+  empty_jobs(100000);
+  empty_jobs(1000000);
+  dependency_chain(10000);
+  parallel_for(100000, 4096);
+  parallel_for(1000000, 4096);
+  parallel_for(1000000, 65536);
+
+  // SetProfileHook() must not race with running jobs, every job above has been waited for.
+  profile_hook(1000000);
+
+  JobSystem::Get().Shutdown();
+  return 0;
+}
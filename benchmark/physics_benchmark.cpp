@@ -0,0 +1,92 @@
+/**
+ * @file physics_benchmark.cpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief Fixed step cost of PhysicsWorld with 50k dynamic bodies, narrow-phase serial and on the job system.
+ * @version 0.1
+ * @date 2024-08-10
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "core/job_system.hpp"
+#include "scene/component.hpp"
+#include "scene/physics_world.hpp"
+
+using namespace MEngine;
+
+using Clock = std::chrono::steady_clock;
+
+static void populate(entt::registry &registry, size_t body_count) {
+  // Bodies fall into a walled pit, so contacts build up over the run.
+  const float extent = std::sqrt(static_cast<float>(body_count)) * 1.5f;
+
+  std::mt19937                          rng(7);
+  std::uniform_real_distribution<float> position(-extent * 0.5f, extent * 0.5f);
+  std::uniform_real_distribution<float> velocity(-1.0f, 1.0f);
+  std::uniform_real_distribution<float> size(0.3f, 0.6f);
+
+  for (size_t i = 0; i < body_count; i++) {
+    auto entity      = registry.create();
+    auto &body       = registry.emplace<RigidBody2D>(entity, RigidBody2D::Type::Dynamic);
+    body.velocity    = {velocity(rng), velocity(rng)};
+    body.restitution = 0.2f;
+    glm::vec3 center(position(rng), position(rng), 0.0f);
+    if (i % 2 == 0) {
+      registry.emplace<AABB>(entity, center, glm::vec3(size(rng), size(rng), 1.0f));
+    } else {
+      registry.emplace<Circle>(entity, center, size(rng) * 0.5f);
+    }
+  }
+
+  auto floor = registry.create();
+  registry.emplace<AABB>(floor, glm::vec3(0.0f, -extent * 0.5f - 1.0f, 0.0f), glm::vec3(extent + 4.0f, 2.0f, 1.0f));
+  auto left = registry.create();
+  registry.emplace<AABB>(left, glm::vec3(-extent * 0.5f - 1.0f, 0.0f, 0.0f), glm::vec3(2.0f, extent + 4.0f, 1.0f));
+  auto right = registry.create();
+  registry.emplace<AABB>(right, glm::vec3(extent * 0.5f + 1.0f, 0.0f, 0.0f), glm::vec3(2.0f, extent + 4.0f, 1.0f));
+}
+
+static void run(size_t body_count, unsigned int workers) {
+  entt::registry registry;
+  populate(registry, body_count);
+
+  PhysicsWorld world;
+  world.SetWorkerCount(workers);
+
+  const int steps = 300;
+
+  double   worst_ms  = 0.0;
+  uint64_t contacts  = 0;
+  auto     run_start = Clock::now();
+  for (int i = 0; i < steps; i++) {
+    auto start = Clock::now();
+    world.StepFixed(registry);
+    worst_ms = std::max(worst_ms, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    contacts += world.GetStats().contacts;
+  }
+  double average_ms = std::chrono::duration<double, std::milli>(Clock::now() - run_start).count() / steps;
+
+  std::printf("%6zu bodies | %2u workers | %7.3f ms/step avg | %7.3f ms worst | %6.1f contacts/step | budget %s\n",
+              body_count, workers, average_ms, worst_ms, static_cast<double>(contacts) / steps,
+              average_ms <= 1000.0 / 60.0 ? "ok" : "over");
+}
+
+int main() {
+  JobSystem::Get().Initialize();
+
+  unsigned int hardware_threads = JobSystem::Get().GetThreadCount();
+  for (size_t count : {10000, 50000}) {
+    run(count, 1);
+    if (hardware_threads > 1) run(count, hardware_threads);
+  }
+
+  JobSystem::Get().Shutdown();
+  return 0;
+}
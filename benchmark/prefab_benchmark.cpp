@@ -0,0 +1,113 @@
+/**
+ * @file prefab_benchmark.cpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief Spawning bullets and small hierarchies through Scene::Instantiate against one CreateEntity per entity.
+ * @version 0.1
+ * @date 2024-08-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "scene/component.hpp"
+#include "scene/prefab.hpp"
+#include "scene/scene.hpp"
+
+using namespace MEngine;
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_ms(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static void add_bullet_components(Entity entity, const Transform &transform) {
+  entity.AddComponent<Transform>(transform);
+  entity.AddComponent<Sprite2D>(glm::vec4(1.0f, 0.9f, 0.2f, 1.0f));
+  entity.AddComponent<RigidBody2D>(RigidBody2D::Type::Kinematic);
+  entity.AddComponent<Circle>(transform.translation, 0.1f);
+}
+
+static std::vector<Transform> spawn_points(size_t count) {
+  std::vector<Transform> transforms(count);
+  for (size_t i = 0; i < count; i++) {
+    transforms[i].translation = glm::vec3(static_cast<float>(i % 100), static_cast<float>(i / 100), 0.0f);
+  }
+  return transforms;
+}
+
+static void bullets(size_t count) {
+  std::vector<Transform> transforms = spawn_points(count);
+
+  Scene one_by_one;
+  auto  start = Clock::now();
+  for (size_t i = 0; i < count; i++) {
+    add_bullet_components(one_by_one.CreateEntity("Bullet"), transforms[i]);
+  }
+  double create_ms = elapsed_ms(start);
+
+  Scene  source;
+  Entity bullet = source.CreateEntity("Bullet");
+  add_bullet_components(bullet, Transform());
+  auto prefab = Prefab::Create(bullet);
+
+  Scene scene;
+  start                     = Clock::now();
+  std::vector<Entity> roots = scene.Instantiate(*prefab, count, transforms);
+  double instantiate_ms     = elapsed_ms(start);
+
+  const glm::vec3 &last   = roots.back().GetComponent<Transform>().translation;
+  bool             placed = roots.size() == count && last == transforms.back().translation;
+  std::printf("%8zu bullets | CreateEntity %8.3f ms | Instantiate %8.3f ms | %5.1fx | %s\n", count, create_ms,
+              instantiate_ms, create_ms / instantiate_ms, placed ? "ok" : "WRONG");
+}
+
+/**
+ * @brief An enemy with a sprite child and a collider child, checks that every copy links to its own entities.
+ *
+ */
+static void enemies(size_t count) {
+  Scene  source;
+  Entity enemy = source.CreateEntity("Enemy");
+  enemy.AddComponent<Transform>();
+  enemy.AddComponent<RigidBody2D>();
+  Entity body = source.CreateEntity("Body");
+  body.AddComponent<Transform>();
+  body.AddComponent<Sprite2D>(glm::vec4(0.8f, 0.1f, 0.1f, 1.0f));
+  Entity hitbox = source.CreateEntity("Hitbox");
+  hitbox.AddComponent<Transform>();
+  hitbox.AddComponent<AABB>(glm::vec3(0.0f), glm::vec3(1.0f));
+  source.SetParent(hitbox, enemy);
+  source.SetParent(body, enemy);
+  auto prefab = Prefab::Create(enemy);
+
+  Scene  scene;
+  auto   start          = Clock::now();
+  auto   roots          = scene.Instantiate(*prefab, count, spawn_points(count));
+  double instantiate_ms = elapsed_ms(start);
+
+  start = Clock::now();
+  scene.UpdateTransforms();
+  double update_ms = elapsed_ms(start);
+
+  size_t linked = 0;
+  for (auto root : roots) {
+    size_t children = 0;
+    scene.ForEachChild(root, [&](Entity child) { children += scene.GetParent(child) == root; });
+    linked += children == 2;
+  }
+  std::printf("%8zu enemies | Instantiate %8.3f ms | UpdateTransforms %8.3f ms | %s\n", count, instantiate_ms,
+              update_ms, linked == count && scene.GetEntityCount() == count * 3 ? "ok" : "WRONG");
+}
+
+int main() {
+  bullets(1000);
+  bullets(10000);
+  bullets(100000);
+  enemies(10000);
+  return 0;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file scene_delta_benchmark.cpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief Cost of the editor's play snapshot and of undoing a single property edit.
+ * @version 0.1
+ * @date 2024-08-24
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "scene/component.hpp"
+#include "scene/scene.hpp"
+#include "scene/scene_delta.hpp"
+
+using namespace MEngine;
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_ms(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Sprites with a falling body on every fourth one, so playing moves a quarter of the scene.
+ *
+ */
+static void populate(Scene &scene, size_t count) {
+  std::mt19937                          rng(5);
+  std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+
+  Entity previous;
+  for (size_t i = 0; i < count; i++) {
+    Entity entity = scene.CreateEntity("Entity " + std::to_string(i));
+    entity.AddComponent<Transform>(glm::vec3(position(rng), position(rng), 0.0f));
+    entity.AddComponent<Sprite2D>(glm::vec4(1.0f, 0.5f, 0.25f, 1.0f));
+    if (i % 4 == 0) {
+      entity.AddComponent<AABB>(entity.GetComponent<Transform>().translation, glm::vec3(1.0f));
+      entity.AddComponent<RigidBody2D>();
+    }
+    if (i % 10 == 0 && i > 0) scene.SetParent(entity, previous);
+    previous = entity;
+  }
+  scene.UpdateTransforms();
+}
+
+/**
+ * @brief Order independent digest of what play mode changes.
+ *
+ */
+static uint64_t checksum(Scene &scene) {
+  uint64_t sum = scene.GetEntityCount();
+  scene.Each<ID, Transform>([&](Entity entity, ID &id, Transform &transform) {
+    uint32_t x, y;
+    std::memcpy(&x, &transform.translation.x, sizeof(x));
+    std::memcpy(&y, &transform.translation.y, sizeof(y));
+    sum ^= static_cast<uint64_t>(id.id) * 31 + x * 7 + y;
+  });
+  return sum;
+}
+
+static void play_and_stop(size_t count) {
+  Scene scene;
+  populate(scene, count);
+  uint64_t before = checksum(scene);
+
+  SceneDelta snapshot;
+  auto start = Clock::now();
+  snapshot.RecordScene(scene);
+  double capture_ms = elapsed_ms(start);
+
+  // A few simulated frames, plus entities spawned and destroyed by gameplay.
+  for (int tick = 0; tick < 10; tick++) {
+    scene.Tick(1.0f / 60.0f);
+  }
+  std::vector<Entity> doomed;
+  scene.Each<AABB>([&](Entity entity, AABB &) {
+    if (doomed.size() < count / 100) doomed.push_back(entity);
+  });
+  for (auto entity : doomed) {
+    scene.DestroyEntity(entity);
+  }
+  for (size_t i = 0; i < count / 100; i++) {
+    scene.CreateEntity("Spawned").AddComponent<Transform>();
+  }
+  uint64_t played = checksum(scene);
+
+  start             = Clock::now();
+  snapshot.Apply(scene);
+  double restore_ms = elapsed_ms(start);
+  scene.UpdateTransforms();
+
+  std::printf("%8zu entities | capture %8.2f ms | restore %8.2f ms | %s\n", count, capture_ms, restore_ms,
+              checksum(scene) == before && played != before ? "restored" : "MISMATCH");
+}
+
+static void undo_edit(size_t count, size_t edits) {
+  Scene scene;
+  populate(scene, count);
+
+  std::vector<Entity> entities;
+  scene.Each<Transform>([&](Entity entity, Transform &) { entities.push_back(entity); });
+  uint64_t before = checksum(scene);
+
+  // One delta per edit, as the editor's undo stack holds them.
+  std::vector<SceneDelta> undo(edits);
+  auto                    start = Clock::now();
+  for (size_t i = 0; i < edits; i++) {
+    Entity entity = entities[i * 7919 % entities.size()];
+    undo[i].Record<Transform>(entity);
+    entity.Patch<Transform>([](Transform &transform) { transform.translation.x += 1.0f; });
+  }
+  double record_ms = elapsed_ms(start);
+
+  std::vector<SceneDelta> redo(edits);
+  start = Clock::now();
+  for (size_t i = edits; i-- > 0;) {
+    undo[i].Apply(scene, &redo[i]);
+  }
+  double undo_ms = elapsed_ms(start);
+
+  bool restored = checksum(scene) == before;
+  std::printf("%8zu entities | %6zu edits  | record %7.3f us | undo %7.3f us | %s\n", count, edits,
+              record_ms * 1000.0 / edits, undo_ms * 1000.0 / edits, restored ? "restored" : "MISMATCH");
+}
+
+int main() {
+  play_and_stop(10000);
+  play_and_stop(100000);
+  undo_edit(100000, 1000);
+  return 0;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file scene_serialization_benchmark.cpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief Save and load round trip of binary and text scene files with up to 1M entities.
+ * @version 0.1
+ * @date 2024-08-21
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+
+#include "scene/component.hpp"
+#include "scene/scene.hpp"
+#include "scene/scene_serializer.hpp"
+
+using namespace MEngine;
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_ms(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * @brief A level-like mix: every entity is a sprite, a quarter collide, and every
+ * tenth entity is the child of the one before it.
+ *
+ */
+static void populate(Scene &scene, size_t count) {
+  std::mt19937                          rng(11);
+  std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+
+  Entity previous;
+  for (size_t i = 0; i < count; i++) {
+    Entity entity = scene.CreateEntity("Entity " + std::to_string(i));
+    entity.AddComponent<Transform>(glm::vec3(position(rng), position(rng), 0.0f));
+    entity.AddComponent<Sprite2D>(glm::vec4(1.0f, 0.5f, 0.25f, 1.0f));
+    if (i % 4 == 0) entity.AddComponent<AABB>(glm::vec3(0.0f), glm::vec3(1.0f));
+    if (i % 10 == 0 && i > 0) scene.SetParent(entity, previous);
+    previous = entity;
+  }
+}
+
+/**
+ * @brief Order independent digest of the data that has to survive the round trip.
+ *
+ */
+static uint64_t checksum(Scene &scene) {
+  uint64_t sum = 0;
+  scene.Each<ID, Transform>([&](Entity entity, ID &id, Transform &transform) {
+    uint32_t x;
+    std::memcpy(&x, &transform.translation.x, sizeof(x));
+    Entity   parent = scene.GetParent(entity);
+    uint64_t link   = parent == Entity() ? 0 : static_cast<uint64_t>(parent.GetComponent<ID>().id);
+    sum ^= (static_cast<uint64_t>(id.id) * 31 + x) ^ (link * 17);
+  });
+  return sum;
+}
+
+static void round_trip(Scene &source, const std::string &path) {
+  auto   start   = Clock::now();
+  bool   saved   = source.SaveScene(path);
+  double save_ms = elapsed_ms(start);
+
+  Scene loaded;
+  start          = Clock::now();
+  bool   ok      = saved && loaded.LoadScene(path);
+  double load_ms = elapsed_ms(start);
+
+  // Includes rebuilding the world transforms and the spatial index of every loaded entity.
+  start = Clock::now();
+  loaded.UpdateTransforms();
+  double update_ms = elapsed_ms(start);
+
+  bool   same = ok && loaded.GetEntityCount() == source.GetEntityCount() && checksum(loaded) == checksum(source);
+  double mb   = static_cast<double>(std::filesystem::file_size(path)) / (1024.0 * 1024.0);
+
+  std::printf("%8zu entities | %-6s | %7.1f MB | save %8.2f ms | load %8.2f ms (%7.1f MB/s) | "
+              "first update %8.2f ms | %s\n",
+              source.GetEntityCount(), SceneSerializer::IsTextPath(path) ? "text" : "binary", mb, save_ms, load_ms,
+              mb / (load_ms / 1000.0), update_ms, same ? "round trip ok" : "ROUND TRIP MISMATCH");
+  std::filesystem::remove(path);
+}
+
+static void run(size_t count) {
+  Scene source;
+  populate(source, count);
+
+  auto directory = std::filesystem::temp_directory_path();
+  round_trip(source, (directory / "mengine_scene_benchmark.mscene").string());
+  round_trip(source, (directory / "mengine_scene_benchmark.scene").string());
+}
+
+int main() {
+  run(10000);
+  run(100000);
+  run(1000000);
+
+  return 0;
+}
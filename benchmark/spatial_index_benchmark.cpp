@@ -0,0 +1,105 @@
+/**
+ * @file spatial_index_benchmark.cpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief Build, update and query cost of SpatialIndex against a linear scan.
+ * @version 0.1
+ * @date 2024-08-08
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "scene/spatial_index.hpp"
+
+using namespace MEngine;
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_ms(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static void run(size_t entity_count) {
+  // Keep the density constant: about one entity per 4 square units.
+  const float world_extent = std::sqrt(static_cast<float>(entity_count)) * 2.0f;
+
+  std::mt19937                          rng(42);
+  std::uniform_real_distribution<float> position(-world_extent * 0.5f, world_extent * 0.5f);
+  std::uniform_real_distribution<float> size(0.5f, 2.0f);
+  std::uniform_real_distribution<float> step(-0.1f, 0.1f);
+
+  entt::registry            registry;
+  std::vector<entt::entity> entities(entity_count);
+  std::vector<Bounds2D>     bounds(entity_count);
+  for (size_t i = 0; i < entity_count; i++) {
+    entities[i] = registry.create();
+    bounds[i]   = Bounds2D::FromCenter({position(rng), position(rng)}, glm::vec2(size(rng)) * 0.5f);
+  }
+
+  SpatialIndex index(4.0f);
+
+  auto start = Clock::now();
+  for (size_t i = 0; i < entity_count; i++) {
+    index.Update(entities[i], bounds[i]);
+  }
+  double build_ms = elapsed_ms(start);
+
+  // Move 10% of the entities by a small step, most of them stay in their cells.
+  start = Clock::now();
+  for (size_t i = 0; i < entity_count; i += 10) {
+    glm::vec2 offset(step(rng), step(rng));
+    bounds[i] = Bounds2D(bounds[i].min + offset, bounds[i].max + offset);
+    index.Update(entities[i], bounds[i]);
+  }
+  double update_ms = elapsed_ms(start);
+
+  // Camera sized range queries.
+  const int                 query_count = 1000;
+  const glm::vec2           view_half_extents(16.0f, 9.0f);
+  std::vector<entt::entity> result;
+  size_t                    found = 0;
+
+  start = Clock::now();
+  for (int q = 0; q < query_count; q++) {
+    result.clear();
+    index.Query(Bounds2D::FromCenter({position(rng), position(rng)}, view_half_extents), result);
+    found += result.size();
+  }
+  double query_ms = elapsed_ms(start);
+
+  size_t linear_found = 0;
+  start               = Clock::now();
+  for (int q = 0; q < query_count / 10; q++) {
+    Bounds2D view = Bounds2D::FromCenter({position(rng), position(rng)}, view_half_extents);
+    for (size_t i = 0; i < entity_count; i++) {
+      if (bounds[i].Overlaps(view)) linear_found++;
+    }
+  }
+  double linear_ms = elapsed_ms(start) * 10.0;
+
+  start = Clock::now();
+  for (int q = 0; q < query_count; q++) {
+    result.clear();
+    index.Query(glm::vec2(position(rng), position(rng)), result);
+    found += result.size();
+  }
+  double point_ms = elapsed_ms(start);
+
+  std::printf("%8zu entities | build %8.2f ms | update 10%% %7.2f ms | %d range queries %8.2f ms (linear %9.2f ms) | "
+              "%d point queries %6.2f ms | hits %zu\n",
+              entity_count, build_ms, update_ms, query_count, query_ms, linear_ms, query_count, point_ms,
+              found + linear_found);
+}
+
+int main() {
+  for (size_t count : {10000, 100000, 1000000}) {
+    run(count);
+  }
+  return 0;
+}
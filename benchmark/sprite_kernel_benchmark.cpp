@@ -0,0 +1,136 @@
+/**
+ * @file sprite_kernel_benchmark.cpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief Quad vertex generation through glm matrices versus the SpriteKernel paths.
+ * @version 0.1
+ * @date 2024-08-14
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "render/renderer.hpp"
+#include "render/sprite_kernel.hpp"
+#include "scene/component.hpp"
+
+using namespace MEngine;
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_ms(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static const glm::vec4 s_corners[4] = {
+    {-0.5f, -0.5f, 0.0f, 1.0f},
+    {0.5f, -0.5f, 0.0f, 1.0f},
+    {0.5f, 0.5f, 0.0f, 1.0f},
+    {-0.5f, 0.5f, 0.0f, 1.0f},
+};
+
+struct SpriteData {
+  std::vector<float>     x, y, z, sx, sy, rotation;
+  std::vector<glm::vec4> color;
+
+  explicit SpriteData(size_t count) {
+    std::mt19937                          rng(42);
+    std::uniform_real_distribution<float> position(-1000.0f, 1000.0f);
+    std::uniform_real_distribution<float> scale(0.5f, 4.0f);
+    std::uniform_real_distribution<float> angle(-10.0f, 10.0f);
+    for (size_t i = 0; i < count; i++) {
+      x.push_back(position(rng));
+      y.push_back(position(rng));
+      z.push_back(0.0f);
+      sx.push_back(scale(rng));
+      sy.push_back(scale(rng));
+      rotation.push_back(angle(rng));
+      color.push_back(glm::vec4(1.0f));
+    }
+  }
+
+  SpriteStreams GetStreams() const {
+    SpriteStreams streams;
+    streams.position_x = x.data();
+    streams.position_y = y.data();
+    streams.position_z = z.data();
+    streams.scale_x    = sx.data();
+    streams.scale_y    = sy.data();
+    streams.rotation   = rotation.data();
+    streams.color      = color.data();
+    streams.count      = x.size();
+    return streams;
+  }
+};
+
+static float max_error(const std::vector<QuadVertex> &a, const std::vector<QuadVertex> &b) {
+  float error = 0.0f;
+  for (size_t i = 0; i < a.size(); i++) {
+    error = std::max(error, std::abs(a[i].position.x - b[i].position.x));
+    error = std::max(error, std::abs(a[i].position.y - b[i].position.y));
+  }
+  return error;
+}
+
+static void run(size_t count) {
+  const int               frames = 20;
+  SpriteData              data(count);
+  SpriteStreams           streams = data.GetStreams();
+  std::vector<QuadVertex> reference(count * 4);
+  std::vector<QuadVertex> out(count * 4);
+
+  // What Renderer::draw_quad does per sprite: build the model matrix, then transform four corners.
+  auto start = Clock::now();
+  for (int frame = 0; frame < frames; frame++) {
+    for (size_t i = 0; i < count; i++) {
+      Transform transform;
+      transform.translation = glm::vec3(data.x[i], data.y[i], data.z[i]);
+      transform.rotation    = glm::vec3(0.0f, 0.0f, data.rotation[i]);
+      transform.scale       = glm::vec3(data.sx[i], data.sy[i], 1.0f);
+      glm::mat4   model     = transform.GetTransform();
+      QuadVertex *vertex    = &out[i * 4];
+      for (int corner = 0; corner < 4; corner++, vertex++) {
+        vertex->position  = glm::vec3(model * s_corners[corner]);
+        vertex->color     = data.color[i];
+        vertex->tex_coord = glm::vec2(s_corners[corner]) + 0.5f;
+        vertex->tex_index = 0.0f;
+      }
+    }
+  }
+  double glm_ms = elapsed_ms(start) / frames;
+
+  SpriteKernel::EmitQuadsScalar(streams, 0.0f, reference.data());
+  std::printf("%zu sprites | glm %8.3f ms (error %.2e)\n", count, glm_ms, max_error(reference, out));
+
+  const SpriteKernel::Isa isas[] = {SpriteKernel::Isa::Scalar, SpriteKernel::Isa::SSE2, SpriteKernel::Isa::AVX2};
+  for (SpriteKernel::Isa isa : isas) {
+    if (static_cast<int>(isa) > static_cast<int>(SpriteKernel::Detect())) continue;
+    SpriteKernel::SetIsa(isa);
+
+    start = Clock::now();
+    for (int frame = 0; frame < frames; frame++) {
+      SpriteKernel::EmitQuads(streams, 0.0f, out.data());
+    }
+    double kernel_ms = elapsed_ms(start) / frames;
+
+    std::printf("%zu sprites | %-6s %7.3f ms (error %.2e, %.2fx)\n", count, SpriteKernel::GetIsaName(isa), kernel_ms,
+                max_error(reference, out), glm_ms / kernel_ms);
+  }
+  SpriteKernel::SetIsa(SpriteKernel::Detect());
+}
+
+int main() {
+  std::printf("detected: %s\n", SpriteKernel::GetIsaName(SpriteKernel::Detect()));
+
+  run(10000);
+  run(100000);
+  run(1000000);
+
+  return 0;
+}
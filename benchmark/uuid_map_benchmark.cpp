@@ -0,0 +1,129 @@
+/**
+ * @file uuid_map_benchmark.cpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief Insert, lookup and erase of the open-addressing UUIDMap against std::unordered_map.
+ * @version 0.1
+ * @date 2024-08-23
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "core/uuid_map.hpp"
+
+using namespace MEngine;
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_ns(Clock::time_point start, size_t count) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / count;
+}
+
+struct Result {
+  double   insert_ns;
+  double   hit_ns;
+  double   miss_ns;
+  double   erase_ns;
+  uint64_t checksum;
+};
+
+/**
+ * @brief Insert every key, look all of them up in shuffled order, look up absent keys, then erase half.
+ * Both maps go through the same steps so only the container differs.
+ *
+ */
+template <typename Insert, typename Find, typename Erase>
+static Result measure(const std::vector<uint64_t> &keys, const std::vector<uint64_t> &lookups,
+                      const std::vector<uint64_t> &misses, Insert insert, Find find, Erase erase) {
+  Result result{};
+
+  auto start = Clock::now();
+  for (size_t i = 0; i < keys.size(); i++) {
+    insert(keys[i], static_cast<uint32_t>(i));
+  }
+  result.insert_ns = elapsed_ns(start, keys.size());
+
+  start = Clock::now();
+  for (uint64_t key : lookups) {
+    result.checksum += find(key);
+  }
+  result.hit_ns = elapsed_ns(start, lookups.size());
+
+  start = Clock::now();
+  for (uint64_t key : misses) {
+    result.checksum += find(key);
+  }
+  result.miss_ns = elapsed_ns(start, misses.size());
+
+  start = Clock::now();
+  for (size_t i = 0; i < keys.size(); i += 2) {
+    erase(keys[i]);
+  }
+  result.erase_ns = elapsed_ns(start, keys.size() / 2);
+
+  // Lookups after the erase walk the clusters the backward shift compacted.
+  for (size_t i = 0; i < lookups.size(); i += 16) {
+    result.checksum += find(lookups[i]);
+  }
+  return result;
+}
+
+static void print(const char *name, size_t count, const Result &result) {
+  std::printf("%10zu %-18s | insert %6.1f ns | hit %6.1f ns | miss %6.1f ns | erase %6.1f ns | %016llx\n", count,
+              name, result.insert_ns, result.hit_ns, result.miss_ns, result.erase_ns,
+              static_cast<unsigned long long>(result.checksum));
+}
+
+static void run(size_t count) {
+  std::mt19937_64 rng(count);
+
+  std::vector<uint64_t> keys(count);
+  for (auto &key : keys) {
+    do {
+      key = rng();
+    } while (key == 0);
+  }
+  std::vector<uint64_t> lookups = keys;
+  std::shuffle(lookups.begin(), lookups.end(), rng);
+  std::vector<uint64_t> misses(count);
+  for (auto &key : misses) {
+    key = rng() | 1;
+  }
+
+  {
+    UUIDMap<uint32_t> map;
+    Result            result = measure(
+        keys, lookups, misses, [&](uint64_t key, uint32_t value) { map.Insert(UUID(key), value); },
+        [&](uint64_t key) -> uint32_t {
+          const uint32_t *value = map.Find(UUID(key));
+          return value ? *value : 0;
+        },
+        [&](uint64_t key) { map.Erase(UUID(key)); });
+    print("UUIDMap", count, result);
+  }
+  {
+    std::unordered_map<UUID, uint32_t> map;
+    Result                             result = measure(
+        keys, lookups, misses, [&](uint64_t key, uint32_t value) { map.emplace(UUID(key), value); },
+        [&](uint64_t key) -> uint32_t {
+          auto it = map.find(UUID(key));
+          return it != map.end() ? it->second : 0;
+        },
+        [&](uint64_t key) { map.erase(UUID(key)); });
+    print("std::unordered_map", count, result);
+  }
+}
+
+int main() {
+  run(10000);
+  run(1000000);
+  run(4000000);
+  return 0;
+}
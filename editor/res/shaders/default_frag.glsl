@@ -1,11 +1,124 @@
 #version 460 core
+#ifndef MAX_TEXTURE_SLOTS
+#define MAX_TEXTURE_SLOTS 16
+#endif
+
 out vec4 FragColor;
 
+in vec4 Color;
 in vec2 TexCoord;
+in flat float TexIndex;
+
+uniform sampler2D textures[MAX_TEXTURE_SLOTS];
+
+// The slot differs between the quads of one draw, so it is not dynamically uniform and
+// must not index the sampler array. Every case below indexes it with a constant instead.
+#define SLOT(n) case n: return texture(textures[n], uv);
+
+vec4 sample_slot(int slot, vec2 uv)
+{
+    switch (slot) {
+        SLOT(0)
+#if MAX_TEXTURE_SLOTS > 1
+        SLOT(1)
+#endif
+#if MAX_TEXTURE_SLOTS > 2
+        SLOT(2)
+#endif
+#if MAX_TEXTURE_SLOTS > 3
+        SLOT(3)
+#endif
+#if MAX_TEXTURE_SLOTS > 4
+        SLOT(4)
+#endif
+#if MAX_TEXTURE_SLOTS > 5
+        SLOT(5)
+#endif
+#if MAX_TEXTURE_SLOTS > 6
+        SLOT(6)
+#endif
+#if MAX_TEXTURE_SLOTS > 7
+        SLOT(7)
+#endif
+#if MAX_TEXTURE_SLOTS > 8
+        SLOT(8)
+#endif
+#if MAX_TEXTURE_SLOTS > 9
+        SLOT(9)
+#endif
+#if MAX_TEXTURE_SLOTS > 10
+        SLOT(10)
+#endif
+#if MAX_TEXTURE_SLOTS > 11
+        SLOT(11)
+#endif
+#if MAX_TEXTURE_SLOTS > 12
+        SLOT(12)
+#endif
+#if MAX_TEXTURE_SLOTS > 13
+        SLOT(13)
+#endif
+#if MAX_TEXTURE_SLOTS > 14
+        SLOT(14)
+#endif
+#if MAX_TEXTURE_SLOTS > 15
+        SLOT(15)
+#endif
+#if MAX_TEXTURE_SLOTS > 16
+        SLOT(16)
+#endif
+#if MAX_TEXTURE_SLOTS > 17
+        SLOT(17)
+#endif
+#if MAX_TEXTURE_SLOTS > 18
+        SLOT(18)
+#endif
+#if MAX_TEXTURE_SLOTS > 19
+        SLOT(19)
+#endif
+#if MAX_TEXTURE_SLOTS > 20
+        SLOT(20)
+#endif
+#if MAX_TEXTURE_SLOTS > 21
+        SLOT(21)
+#endif
+#if MAX_TEXTURE_SLOTS > 22
+        SLOT(22)
+#endif
+#if MAX_TEXTURE_SLOTS > 23
+        SLOT(23)
+#endif
+#if MAX_TEXTURE_SLOTS > 24
+        SLOT(24)
+#endif
+#if MAX_TEXTURE_SLOTS > 25
+        SLOT(25)
+#endif
+#if MAX_TEXTURE_SLOTS > 26
+        SLOT(26)
+#endif
+#if MAX_TEXTURE_SLOTS > 27
+        SLOT(27)
+#endif
+#if MAX_TEXTURE_SLOTS > 28
+        SLOT(28)
+#endif
+#if MAX_TEXTURE_SLOTS > 29
+        SLOT(29)
+#endif
+#if MAX_TEXTURE_SLOTS > 30
+        SLOT(30)
+#endif
+#if MAX_TEXTURE_SLOTS > 31
+        SLOT(31)
+#endif
+    }
+    return vec4(1.0);
+}
 
-uniform sampler2D texture1;
+#undef SLOT
 
 void main()
 {
-    FragColor = texture(texture1, TexCoord);
+    FragColor = sample_slot(int(TexIndex), TexCoord) * Color;
 }
\ No newline at end of file
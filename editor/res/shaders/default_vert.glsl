@@ -1,13 +1,21 @@
 #version 460 core
-layout(location = 0) in vec3 aPos;  // 位置变量的属性位置值为0
-layout(location = 1) in vec2 aTexCoord;
+layout(location = 0) in vec3  aPos;
+layout(location = 1) in vec4  aColor;
+layout(location = 2) in vec2  aTexCoord;
+layout(location = 3) in float aTexIndex;
 
+out vec4 Color;
 out vec2 TexCoord;
+out flat float TexIndex;
 
-uniform mat4 model;
-uniform mat4 proj_view;
+layout(std140, binding = 0) uniform Camera {
+  mat4 proj_view;
+};
 
 void main() {
-  gl_Position = proj_view * model * vec4(aPos, 1.0);
+  // 顶点已经在 CPU 端变换到世界空间
+  gl_Position = proj_view * vec4(aPos, 1.0);
+  Color       = aColor;
   TexCoord    = aTexCoord;
+  TexIndex    = aTexIndex;
 }
\ No newline at end of file
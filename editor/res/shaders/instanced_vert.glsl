@@ -0,0 +1,29 @@
+#version 460 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aTexCoord;
+
+// 每个实例的数据
+layout(location = 2) in vec2  iAxisX;
+layout(location = 3) in vec2  iAxisY;
+layout(location = 4) in vec3  iPosition;
+layout(location = 5) in vec4  iColor;
+layout(location = 6) in vec4  iUVRect;
+layout(location = 7) in float iTexIndex;
+
+out vec4 Color;
+out vec2 TexCoord;
+out flat float TexIndex;
+
+layout(std140, binding = 0) uniform Camera {
+  mat4 proj_view;
+};
+
+void main() {
+  // 模型矩阵的 x/y 列直接组成角点，镜像与错切也保持不变
+  vec2 world = iAxisX * aPos.x + iAxisY * aPos.y + iPosition.xy;
+
+  gl_Position = proj_view * vec4(world, iPosition.z, 1.0);
+  Color       = iColor;
+  TexCoord    = mix(iUVRect.xy, iUVRect.zw, aTexCoord);
+  TexIndex    = iTexIndex;
+}
\ No newline at end of file
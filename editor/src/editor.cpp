@@ -16,8 +16,11 @@
 // #include <ImGuizmo.h>
 // clang-format on
 
+#include "core/asset_manager.hpp"
 #include "core/input.hpp"
+#include "render/render_state.hpp"
 #include "render/renderer.hpp"
+#include "scene/prefab.hpp"
 
 Editor::Editor() {}
 
@@ -96,9 +99,24 @@ void Editor::OnUpdate(float dt) {
       ImGui::EndMenu();
     }
 
+    bool editing = game_mode_ == GameMode::Edit;
+    if (ImGui::BeginMenu("Edit")) {
+      if (ImGui::MenuItem("Undo", "Ctrl+Z", false, editing && !undo_stack_.empty())) Undo();
+      if (ImGui::MenuItem("Redo", "Ctrl+Y", false, editing && !redo_stack_.empty())) Redo();
+
+      ImGui::EndMenu();
+    }
+
     ImGui::EndMenuBar();
   }
 
+  // Text fields handle these keys themselves.
+  ImGuiIO &io = ImGui::GetIO();
+  if (game_mode_ == GameMode::Edit && io.KeyCtrl && !io.WantTextInput) {
+    if (ImGui::IsKeyPressed(GLFW_KEY_Z, false)) Undo();
+    if (ImGui::IsKeyPressed(GLFW_KEY_Y, false)) Redo();
+  }
+
   // Content Browser
   ImGui::Begin("Content Browser");
 
@@ -173,6 +191,28 @@ void Editor::OnUpdate(float dt) {
   // print fps
   ImGui::Begin("Information");
   ImGui::Text("FPS: %d", GetFPS());
+  const auto &render_stats = active_scene_->GetRenderer()->GetStats();
+  ImGui::Text("Draw Calls: %u", render_stats.draw_calls);
+  ImGui::Text("Quads: %u", render_stats.quad_count);
+  ImGui::Text("Quads/Batch: %.1f", render_stats.GetQuadsPerBatch());
+  ImGui::Text("Texture Binds: %u", render_stats.texture_binds);
+  ImGui::Text("Stream Stalls: %u", render_stats.stream_stalls);
+  const auto &scene_stats = active_scene_->GetStats();
+  ImGui::Text("Sprites: %u visible, %u culled", scene_stats.visible_sprites, scene_stats.culled_sprites);
+  ImGui::Text("Streamed Sprites: %u", scene_stats.streamed_sprites);
+  ImGui::Text("Transforms Updated: %u", scene_stats.transforms_updated);
+  const auto &physics_stats = active_scene_->GetPhysicsWorld().GetStats();
+  ImGui::Text("Physics: %u bodies, %u pairs, %u contacts", physics_stats.bodies, physics_stats.candidate_pairs,
+              physics_stats.contacts);
+  const auto &asset_stats = AssetManager::Get().GetStats();
+  ImGui::Text("Textures: %u ready, %u loading, %u failed", asset_stats.ready, asset_stats.loading, asset_stats.failed);
+  const auto &state_stats = RenderState::GetFrameStats();
+  ImGui::Text("GL State Calls: %u issued, %u elided", state_stats.issued, state_stats.elided);
+  bool instanced = active_scene_->GetRenderer()->GetRenderMode() == Renderer::RenderMode::Instanced;
+  if (ImGui::Checkbox("Instanced Sprites", &instanced)) {
+    active_scene_->GetRenderer()->SetRenderMode(instanced ? Renderer::RenderMode::Instanced
+                                                          : Renderer::RenderMode::Batched);
+  }
   // control editor camera
   ImGui::Text("Camera Control");
   if (ImGui::DragFloat2("Position", glm::value_ptr(editor_camera_info_->GetPosition()), 0.1f)) {
@@ -266,15 +306,21 @@ void Editor::BeginImGui() {
 void Editor::EndImGui() {
   ImGui::Render();
   ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+  // The ImGui backend binds its own program, buffers and textures.
+  RenderState::Invalidate();
 }
 
+/**
+ * @brief Inspector section of component `T`. `uiFunction` edits a copy and returns true when a widget
+ * changed it. Edits and removal are recorded into `edit` unless it is nullptr.
+ *
+ */
 template <typename T, typename UIFunction>
-static void DrawComponent(const std::string &name, Entity entity, UIFunction uiFunction) {
+static void DrawComponent(const std::string &name, Entity entity, SceneDelta *edit, UIFunction uiFunction) {
   const ImGuiTreeNodeFlags treeNodeFlags = ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_Framed |
                                            ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_AllowItemOverlap |
                                            ImGuiTreeNodeFlags_FramePadding;
   if (entity.HasComponent<T>()) {
-    auto  &component              = entity.GetComponent<T>();
     ImVec2 contentRegionAvailable = ImGui::GetContentRegionAvail();
 
     ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2{4, 4});
@@ -295,18 +341,32 @@ static void DrawComponent(const std::string &name, Entity entity, UIFunction uiF
     }
 
     if (open) {
-      uiFunction(component);
+      // Only a real edit is patched in, so cached data derived from the component is refreshed
+      // without marking it dirty on every frame the inspector is open.
+      T value = entity.GetComponent<T>();
+      if (uiFunction(value)) {
+        if (edit) edit->Record<T>(entity, entity.GetComponent<T>());
+        entity.Patch<T>([&](auto &component) { component = value; });
+      }
       ImGui::TreePop();
     }
 
-    if (removeComponent) entity.RemoveComponent<T>();
+    if (removeComponent) {
+      if (edit) edit->Record<T>(entity);
+      entity.RemoveComponent<T>();
+    }
   }
 }
 
-static void DrawVec3Control(const std::string &label, glm::vec3 &values, float resetValue = 0.0f,
+/**
+ * @brief Three drag fields with reset buttons, true when one of them changed `values`.
+ *
+ */
+static bool DrawVec3Control(const std::string &label, glm::vec3 &values, float resetValue = 0.0f,
                             float columnWidth = 100.0f) {
   ImGuiIO &io       = ImGui::GetIO();
   auto     boldFont = io.Fonts->Fonts[0];
+  bool     changed  = false;
 
   ImGui::PushID(label.c_str());
 
@@ -325,12 +385,15 @@ static void DrawVec3Control(const std::string &label, glm::vec3 &values, float r
   ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4{0.9f, 0.2f, 0.2f, 1.0f});
   ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4{0.8f, 0.1f, 0.15f, 1.0f});
   ImGui::PushFont(boldFont);
-  if (ImGui::Button("X", buttonSize)) values.x = resetValue;
+  if (ImGui::Button("X", buttonSize)) {
+    values.x = resetValue;
+    changed   = true;
+  }
   ImGui::PopFont();
   ImGui::PopStyleColor(3);
 
   ImGui::SameLine();
-  ImGui::DragFloat("##X", &values.x, 0.1f, 0.0f, 0.0f, "%.2f");
+  changed |= ImGui::DragFloat("##X", &values.x, 0.1f, 0.0f, 0.0f, "%.2f");
   ImGui::PopItemWidth();
   ImGui::SameLine();
 
@@ -338,12 +401,15 @@ static void DrawVec3Control(const std::string &label, glm::vec3 &values, float r
   ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4{0.3f, 0.8f, 0.3f, 1.0f});
   ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4{0.2f, 0.7f, 0.2f, 1.0f});
   ImGui::PushFont(boldFont);
-  if (ImGui::Button("Y", buttonSize)) values.y = resetValue;
+  if (ImGui::Button("Y", buttonSize)) {
+    values.y = resetValue;
+    changed   = true;
+  }
   ImGui::PopFont();
   ImGui::PopStyleColor(3);
 
   ImGui::SameLine();
-  ImGui::DragFloat("##Y", &values.y, 0.1f, 0.0f, 0.0f, "%.2f");
+  changed |= ImGui::DragFloat("##Y", &values.y, 0.1f, 0.0f, 0.0f, "%.2f");
   ImGui::PopItemWidth();
   ImGui::SameLine();
 
@@ -351,12 +417,15 @@ static void DrawVec3Control(const std::string &label, glm::vec3 &values, float r
   ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4{0.2f, 0.35f, 0.9f, 1.0f});
   ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4{0.1f, 0.25f, 0.8f, 1.0f});
   ImGui::PushFont(boldFont);
-  if (ImGui::Button("Z", buttonSize)) values.z = resetValue;
+  if (ImGui::Button("Z", buttonSize)) {
+    values.z = resetValue;
+    changed   = true;
+  }
   ImGui::PopFont();
   ImGui::PopStyleColor(3);
 
   ImGui::SameLine();
-  ImGui::DragFloat("##Z", &values.z, 0.1f, 0.0f, 0.0f, "%.2f");
+  changed |= ImGui::DragFloat("##Z", &values.z, 0.1f, 0.0f, 0.0f, "%.2f");
   ImGui::PopItemWidth();
 
   ImGui::PopStyleVar();
@@ -364,12 +433,15 @@ static void DrawVec3Control(const std::string &label, glm::vec3 &values, float r
   ImGui::Columns(1);
 
   ImGui::PopID();
+
+  return changed;
 }
 
 template <typename T>
 void Editor::DisplayAddComponentEntry(const std::string &entryName) {
   if (!selected_entity_.HasComponent<T>()) {
     if (ImGui::MenuItem(entryName.c_str())) {
+      if (game_mode_ == GameMode::Edit) pending_edit_.Record<T>(selected_entity_);
       selected_entity_.AddComponent<T>();
       ImGui::CloseCurrentPopup();
     }
@@ -388,25 +460,66 @@ void Editor::ShowImGuiScene() {
   // delete selected entity
   if (ImGui::Button("Delete")) {
     if (selected_entity_.GetHandle() != entt::null) {
-      active_scene_->DestroyEntity(selected_entity_);
+      active_scene_->QueueDestroy(selected_entity_);
       selected_entity_ = Entity();
     }
   }
 
-  std::vector<Entity> &entities = active_scene_->GetAllEntities();
+  // Reparenting only rewrites Relationship values and new children are not visited, so the view stays valid.
+  active_scene_->Each<Relationship>([this](Entity entity, Relationship &relationship) {
+    if (relationship.parent == entt::null) ShowImGuiEntityNode(entity);
+  });
 
-  for (Entity &entity : entities) {
-    auto              &tag = entity.GetComponent<Tag>().tag;
-    ImGuiTreeNodeFlags flags =
-        ((entity == selected_entity_) ? ImGuiTreeNodeFlags_Selected : 0) | ImGuiTreeNodeFlags_OpenOnArrow;
-    bool opened = ImGui::TreeNodeEx((void *)(intptr_t)entity.GetHandle(), flags, "%s", tag.c_str());
+  ImGui::End();
+}
 
-    if (ImGui::IsItemClicked()) {
-      selected_entity_ = entity;
+void Editor::ShowImGuiEntityNode(Entity entity) {
+  auto              &tag = entity.GetComponent<Tag>().tag;
+  ImGuiTreeNodeFlags flags =
+      ((entity == selected_entity_) ? ImGuiTreeNodeFlags_Selected : 0) | ImGuiTreeNodeFlags_OpenOnArrow;
+  if (entity.GetComponent<Relationship>().children == 0) flags |= ImGuiTreeNodeFlags_Leaf;
+  bool opened = ImGui::TreeNodeEx((void *)(intptr_t)entity.GetHandle(), flags, "%s", tag.c_str());
+
+  if (ImGui::IsItemClicked()) {
+    selected_entity_ = entity;
+  }
+
+  // Drag a node onto another one to make it a child.
+  if (ImGui::BeginDragDropSource()) {
+    entt::entity handle = entity.GetHandle();
+    ImGui::SetDragDropPayload("SCENE_ENTITY", &handle, sizeof(handle));
+    ImGui::Text("%s", tag.c_str());
+    ImGui::EndDragDropSource();
+  }
+  if (ImGui::BeginDragDropTarget()) {
+    if (const ImGuiPayload *payload = ImGui::AcceptDragDropPayload("SCENE_ENTITY")) {
+      entt::entity child = *(const entt::entity *)payload->Data;
+      active_scene_->SetParent(Entity(child, entity.GetRegistry()), entity);
     }
+    ImGui::EndDragDropTarget();
   }
 
-  ImGui::End();
+  if (ImGui::BeginPopupContextItem()) {
+    if (ImGui::MenuItem("Create Child")) {
+      active_scene_->SetParent(active_scene_->CreateEntity(), entity);
+    }
+    if (ImGui::MenuItem("Make Root")) {
+      active_scene_->SetParent(entity, Entity());
+    }
+    if (ImGui::MenuItem("Duplicate")) {
+      // The copy of the subtree goes under the same parent as the original.
+      auto   prefab = Prefab::Create(entity);
+      Entity copy   = active_scene_->Instantiate(*prefab, 1).front();
+      active_scene_->SetParent(copy, active_scene_->GetParent(entity));
+      selected_entity_ = copy;
+    }
+    ImGui::EndPopup();
+  }
+
+  if (opened) {
+    active_scene_->ForEachChild(entity, [this](Entity child) { ShowImGuiEntityNode(child); });
+    ImGui::TreePop();
+  }
 }
 
 void Editor::ShowImGuiViewport() {
@@ -429,28 +542,50 @@ void Editor::ShowImGuiViewport() {
 
   if (game_mode_ == GameMode::Edit) {
     if (ImGui::Button("Play", button_size)) {
+      // Play mutates the scene in place, everything it changes is put back on Stop.
+      play_snapshot_.RecordScene(*active_scene_);
       game_mode_ = GameMode::Play;
     }
   } else {
     if (ImGui::Button("Stop", button_size)) {
+      play_snapshot_.Apply(*active_scene_);
+      play_snapshot_.Clear();
       game_mode_ = GameMode::Edit;
+      // May have been created while playing and be gone now.
+      selected_entity_ = Entity();
     }
   }
 
   ImGui::Image((void *)(intptr_t)frame_buffer_->GetTextureId(), size, ImVec2(0, 1), ImVec2(1, 0));
 
+  // Pick the sprite under the cursor through the scene's spatial index.
+  if (game_mode_ == GameMode::Edit && ImGui::IsItemClicked(ImGuiMouseButton_Left)) {
+    ImVec2    image_min = ImGui::GetItemRectMin();
+    ImVec2    image_max = ImGui::GetItemRectMax();
+    ImVec2    mouse     = ImGui::GetMousePos();
+    glm::vec2 uv((mouse.x - image_min.x) / (image_max.x - image_min.x),
+                 (mouse.y - image_min.y) / (image_max.y - image_min.y));
+    glm::vec4 ndc(uv.x * 2.0f - 1.0f, 1.0f - uv.y * 2.0f, 0.0f, 1.0f);
+    glm::vec4 world  = glm::inverse(editor_camera_info_->GetProjectionView()) * ndc;
+    selected_entity_ = active_scene_->PickEntity(glm::vec2(world));
+  }
+
   ImGui::End();
 }
 
 void Editor::ShowImGuiProperties() {
   ImGui::Begin("Properties");
 
+  // Edits made while playing are thrown away on Stop, they are not undoable.
+  SceneDelta *edit = game_mode_ == GameMode::Edit ? &pending_edit_ : nullptr;
+
   if (selected_entity_.GetHandle() != entt::null) {
     auto &tag = selected_entity_.GetComponent<Tag>().tag;
     char  buffer[256];
     memset(buffer, 0, sizeof(buffer));
     strcpy_s(buffer, sizeof(buffer), tag.c_str());
     if (ImGui::InputText("##Tag", buffer, sizeof(buffer))) {
+      if (edit) edit->Record<Tag>(selected_entity_);
       tag = std::string(buffer);
     }
 
@@ -464,52 +599,132 @@ void Editor::ShowImGuiProperties() {
     if (ImGui::BeginPopup("AddComponent")) {
       DisplayAddComponentEntry<Transform>("Transform");
       DisplayAddComponentEntry<Sprite2D>("Sprite2D");
+      DisplayAddComponentEntry<AnimatedSprite2D>("AnimatedSprite2D");
       DisplayAddComponentEntry<Camera2D>("Camera2D");
+      DisplayAddComponentEntry<RigidBody2D>("RigidBody2D");
+      DisplayAddComponentEntry<AABB>("AABB");
+      DisplayAddComponentEntry<Circle>("Circle");
 
       ImGui::EndPopup();
     }
 
     ImGui::PopItemWidth();
 
-    DrawComponent<Transform>("Transform", selected_entity_, [](auto &component) {
-      DrawVec3Control("Translation", component.translation);
+    DrawComponent<Transform>("Transform", selected_entity_, edit, [](auto &component) {
+      bool edited = DrawVec3Control("Translation", component.translation);
+      // Converted back only on an edit, the degree round trip does not give back the same bits.
       glm::vec3 rotation = glm::degrees(component.rotation);
-      DrawVec3Control("Rotation", rotation);
-      component.rotation = glm::radians(rotation);
-      DrawVec3Control("Scale", component.scale, 1.0f);
+      if (DrawVec3Control("Rotation", rotation)) {
+        component.rotation = glm::radians(rotation);
+        edited             = true;
+      }
+      edited |= DrawVec3Control("Scale", component.scale, 1.0f);
+      return edited;
     });
 
-    DrawComponent<Camera2D>("Camera", selected_entity_, [](auto &component) {
-      ImGui::Checkbox("Primary", &component.primary);
+    DrawComponent<Camera2D>("Camera", selected_entity_, edit, [](auto &component) {
+      bool edited = ImGui::Checkbox("Primary", &component.primary);
 
-      DrawVec3Control("Position", component.position);
+      edited |= DrawVec3Control("Position", component.position);
 
-      ImGui::DragFloat("Rotation", &component.rotation, 0.1f);
+      edited |= ImGui::DragFloat("Rotation", &component.rotation, 0.1f);
 
-      ImGui::DragFloat("Zoom Level", &component.zoom_level, 0.1f, 0.0f, 100.0f);
+      edited |= ImGui::DragFloat("Zoom Level", &component.zoom_level, 0.1f, 0.0f, 100.0f);
 
-      ImGui::DragFloat("Aspect Ratio", &component.aspect_ratio, 0.1f);
+      edited |= ImGui::DragFloat("Aspect Ratio", &component.aspect_ratio, 0.1f);
+      return edited;
     });
 
-    DrawComponent<Sprite2D>("Sprite2D", selected_entity_, [](auto &component) {
-      ImGui::ColorEdit4("Color", glm::value_ptr(component.color));
+    DrawComponent<Sprite2D>("Sprite2D", selected_entity_, edit, [](auto &component) {
+      bool edited = ImGui::ColorEdit4("Color", glm::value_ptr(component.color));
 
       ImGui::Button("Texture", ImVec2(100.0f, 0.0f));
       if (ImGui::BeginDragDropTarget()) {
         if (const ImGuiPayload *payload = ImGui::AcceptDragDropPayload("CONTENT_BROWSER_ITEM")) {
-          const wchar_t           *path = (const wchar_t *)payload->Data;
-          std::filesystem::path    texturePath(path);
-          std::shared_ptr<Texture> texture = Texture::Create(texturePath.string());
-          component.texture                = texture;
+          const wchar_t        *path = (const wchar_t *)payload->Data;
+          std::filesystem::path texturePath(path);
+          // Returns at once, the sprite shows the placeholder until the texture is uploaded.
+          TextureHandle texture = AssetManager::Get().LoadTexture(texturePath.string());
+          // Deferred, the undo record of the previous sprite takes its own reference first.
+          AssetManager::Get().ReleaseLater(component.texture);
+          component.texture = texture;
+          edited            = true;
         }
         ImGui::EndDragDropTarget();
       }
 
-      ImGui::DragFloat("Tiling Factor", &component.tiling_factor, 0.1f, 0.0f, 100.0f);
+      edited |= ImGui::DragFloat("Tiling Factor", &component.tiling_factor, 0.1f, 0.0f, 100.0f);
+
+      edited |= ImGui::DragInt("Layer", &component.layer, 1.0f, -128, 127);
+      return edited;
+    });
+
+    DrawComponent<AnimatedSprite2D>("AnimatedSprite2D", selected_entity_, edit, [](auto &component) {
+      bool edited = ImGui::DragInt("Horizontal Frames", &component.h_frames, 1.0f, 1, 64);
+      edited |= ImGui::DragInt("Vertical Frames", &component.v_frames, 1.0f, 1, 64);
+      edited |= ImGui::DragFloat("Frame Time", &component.frame_time, 0.01f, 0.0f, 10.0f);
+      return edited;
     });
+
+    DrawComponent<RigidBody2D>("RigidBody2D", selected_entity_, edit, [](auto &component) {
+      const char *types[] = {"Static", "Kinematic", "Dynamic"};
+      int         type    = static_cast<int>(component.type);
+      bool        edited  = false;
+      if (ImGui::Combo("Type", &type, types, IM_ARRAYSIZE(types))) {
+        component.type = static_cast<RigidBody2D::Type>(type);
+        edited         = true;
+      }
+
+      edited |= ImGui::DragFloat2("Velocity", glm::value_ptr(component.velocity), 0.1f);
+
+      edited |= ImGui::DragFloat("Mass", &component.mass, 0.1f, 0.0f, 1000.0f);
+
+      edited |= ImGui::DragFloat("Restitution", &component.restitution, 0.01f, 0.0f, 1.0f);
+
+      edited |= ImGui::DragFloat("Gravity Scale", &component.gravity_scale, 0.1f);
+      return edited;
+    });
+
+    DrawComponent<AABB>("AABB", selected_entity_, edit, [](auto &component) {
+      bool edited = DrawVec3Control("Position", component.position);
+      edited |= DrawVec3Control("Size", component.scale, 1.0f);
+      return edited;
+    });
+
+    DrawComponent<Circle>("Circle", selected_entity_, edit, [](auto &component) {
+      bool edited = DrawVec3Control("Position", component.position);
+      edited |= ImGui::DragFloat("Radius", &component.radius, 0.1f, 0.0f, 100.0f);
+      return edited;
+    });
+  }
+
+  // A drag is one edit: it is pushed once the widget is released.
+  if (!pending_edit_.IsEmpty() && !ImGui::IsAnyItemActive()) {
+    undo_stack_.push_back(std::move(pending_edit_));
+    pending_edit_.Clear();
+    if (undo_stack_.size() > kMaxUndoSteps) undo_stack_.erase(undo_stack_.begin());
+    redo_stack_.clear();
   }
 
   ImGui::End();
 }
 
+void Editor::Undo() {
+  if (undo_stack_.empty()) return;
+
+  SceneDelta redo;
+  undo_stack_.back().Apply(*active_scene_, &redo);
+  undo_stack_.pop_back();
+  redo_stack_.push_back(std::move(redo));
+}
+
+void Editor::Redo() {
+  if (redo_stack_.empty()) return;
+
+  SceneDelta undo;
+  redo_stack_.back().Apply(*active_scene_, &undo);
+  redo_stack_.pop_back();
+  undo_stack_.push_back(std::move(undo));
+}
+
 Application *CreateApplication() { return new Editor(); }
\ No newline at end of file
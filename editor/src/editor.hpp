@@ -18,6 +18,7 @@
 #include "scene/camera.hpp"
 #include "scene/entity.hpp"
 #include "scene/scene.hpp"
+#include "scene/scene_delta.hpp"
 
 #include <filesystem>
 
@@ -36,9 +37,17 @@ class Editor : public Application {
   void EndImGui();
 
   void ShowImGuiScene();
+  void ShowImGuiEntityNode(Entity entity);
   void ShowImGuiViewport();
   void ShowImGuiProperties();
 
+  /**
+   * @brief Revert the last property edit, Redo() applies it again.
+   *
+   */
+  void Undo();
+  void Redo();
+
   template <typename T>
   void DisplayAddComponentEntry(const std::string &entryName);
 
@@ -53,6 +62,19 @@ class Editor : public Application {
 
   std::shared_ptr<Scene> active_scene_;
 
+  Entity selected_entity_;
+
+  // The scene as it was when Play was pressed, applied again on Stop.
+  SceneDelta play_snapshot_;
+
+  // Each entry reverts one property edit, applying it records the entry for the other stack.
+  static constexpr size_t kMaxUndoSteps = 128;
+  std::vector<SceneDelta> undo_stack_;
+  std::vector<SceneDelta> redo_stack_;
+
+  // Values before the edit in progress, pushed to undo_stack_ once no widget is held anymore.
+  SceneDelta pending_edit_;
+
   std::shared_ptr<FrameBuffer> frame_buffer_;
 
   std::shared_ptr<ScriptEngine> script_engine_;
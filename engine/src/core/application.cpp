@@ -7,16 +7,20 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "core/asset_manager.hpp"
 #include "core/command.hpp"
 #include "core/input.hpp"
+#include "core/job_system.hpp"
 #include "core/script_engine.hpp"
 #include "render/frame_buffer.hpp"
 #include "render/gl.hpp"
+#include "render/render_state.hpp"
 #include "render/renderer.hpp"
 #include "render/shader.hpp"
 #include "scene/camera.hpp"
 #include "scene/component.hpp"
 #include "scene/scene.hpp"
+#include "scene/simulation_thread.hpp"
 
 namespace MEngine {
 
@@ -56,10 +60,16 @@ Application::Application() {
     exit(-1);
   }
 
+  JobSystem::Get().Initialize();
+
   logger_->info("Application initialized");
 }
 
 Application::~Application() {
+  StopSimulationThread();
+  // Textures are GL objects, free them before the context goes away.
+  AssetManager::Get().Shutdown();
+  JobSystem::Get().Shutdown();
   if (window_) {
     glfwDestroyWindow(window_);
   }
@@ -79,13 +89,22 @@ void Application::Run() {
   while (!glfwWindowShouldClose(window_)) {
     float dt = GetDeltaTime();
 
-    glEnable(GL_BLEND);
-    glEnable(GL_DEPTH_TEST);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    RenderState::BeginFrame();
+    AssetManager::Get().Update();
+    RenderState::SetBlend(true);
+    RenderState::SetDepthTest(true);
+    RenderState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     glClearColor(0.6f, 0.6f, 0.6f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    if (simulation_thread_ && simulation_thread_->IsRunning()) {
+      int width, height;
+      glfwGetFramebufferSize(window_, &width, &height);
+      simulation_thread_->SetViewportSize(width, height);
+      simulation_thread_->Draw();
+    }
+
     OnUpdate(dt);
 
     glfwSwapBuffers(window_);
@@ -94,6 +113,15 @@ void Application::Run() {
   }
 }
 
+void Application::StartSimulationThread(std::shared_ptr<Scene> scene, float tick_rate) {
+  if (!simulation_thread_) simulation_thread_ = std::make_unique<SimulationThread>();
+  simulation_thread_->Start(std::move(scene), tick_rate);
+}
+
+void Application::StopSimulationThread() {
+  if (simulation_thread_) simulation_thread_->Stop();
+}
+
 float Application::GetDeltaTime() {
   float current_time = static_cast<float>(glfwGetTime());
   float delta_time   = current_time - prev_time_;
@@ -24,6 +24,7 @@ class FrameBuffer;
 class ScriptEngine;
 class Scene;
 class Renderer;
+class SimulationThread;
 
 /**
  * @brief Application class is the main class that runs the game loop.
@@ -61,6 +62,17 @@ class Application {
 
   std::shared_ptr<Scene> GetScene() { return scene_; }
 
+  /**
+   * @brief Tick `scene` on its own thread at `tick_rate`, Run() then draws its interpolated
+   * snapshots every frame before OnUpdate(). The scene must not be touched until StopSimulationThread().
+   *
+   */
+  void StartSimulationThread(std::shared_ptr<Scene> scene, float tick_rate = 60.0f);
+
+  void StopSimulationThread();
+
+  SimulationThread *GetSimulationThread() { return simulation_thread_.get(); }
+
   static Application *GetInstance();
 
  protected:
@@ -88,6 +100,8 @@ class Application {
 
   std::shared_ptr<ScriptEngine> script_engine_;
 
+  std::unique_ptr<SimulationThread> simulation_thread_;
+
   std::shared_ptr<spdlog::logger> logger_;
 };
 
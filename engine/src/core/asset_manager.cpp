@@ -0,0 +1,273 @@
+#include "core/asset_manager.hpp"
+
+#include <stb_image.h>
+
+#include <chrono>
+#include <cstring>
+
+#include "core/job_system.hpp"
+
+namespace MEngine {
+
+static const std::string s_empty_path;
+
+AssetManager &AssetManager::Get() {
+  static AssetManager manager;
+  return manager;
+}
+
+AssetManager::AssetManager() { logger_ = Logger::Get("AssetManager"); }
+
+AssetManager::~AssetManager() {
+  // The GL objects may already be gone with the context, only the decoded pixels are freed here.
+  for (auto &job : decoded_) {
+    stbi_image_free(job.pixels);
+  }
+}
+
+AssetManager::Slot *AssetManager::get_slot(TextureHandle handle) {
+  return const_cast<Slot *>(static_cast<const AssetManager *>(this)->get_slot(handle));
+}
+
+const AssetManager::Slot *AssetManager::get_slot(TextureHandle handle) const {
+  if (handle == kInvalidHandle) return nullptr;
+  uint32_t index = handle & kIndexMask;
+  if (index >= slots_.size()) return nullptr;
+  const Slot &slot = slots_[index];
+  if (slot.references == 0 || slot.generation != handle >> kIndexBits) return nullptr;
+  return &slot;
+}
+
+TextureHandle AssetManager::allocate(const std::string &path, UUID uuid) {
+  uint32_t index;
+  if (!free_slots_.empty()) {
+    index = free_slots_.back();
+    free_slots_.pop_back();
+  } else {
+    index = static_cast<uint32_t>(slots_.size());
+    slots_.emplace_back();
+  }
+
+  Slot &slot      = slots_[index];
+  slot.path       = path;
+  slot.uuid       = uuid;
+  slot.references = 1;
+  slot.state      = State::Loading;
+
+  TextureHandle handle = make_handle(index, slot.generation);
+  if (!path.empty()) paths_[path] = handle;
+  uuids_[uuid] = handle;
+  return handle;
+}
+
+TextureHandle AssetManager::LoadTexture(const std::string &path) { return LoadTexture(path, UUID()); }
+
+TextureHandle AssetManager::LoadTexture(const std::string &path, UUID uuid) {
+  auto it = paths_.find(path);
+  if (it != paths_.end()) {
+    Slot *slot = get_slot(it->second);
+    slot->references++;
+    if (slot->state == State::Unloaded) {
+      slot->state = State::Loading;
+      queue_decode(it->second, path);
+    }
+    return it->second;
+  }
+
+  TextureHandle handle = allocate(path, uuid);
+  queue_decode(handle, path);
+  return handle;
+}
+
+TextureHandle AssetManager::ReferenceTexture(const std::string &path, UUID uuid) {
+  auto it = paths_.find(path);
+  if (it != paths_.end()) {
+    Acquire(it->second);
+    return it->second;
+  }
+
+  TextureHandle handle = allocate(path, uuid);
+  Slot         *slot   = get_slot(handle);
+  slot->state          = State::Unloaded;
+  return handle;
+}
+
+void AssetManager::queue_decode(TextureHandle handle, const std::string &path) {
+  DecodeJob job;
+  job.index      = handle & kIndexMask;
+  job.generation = static_cast<uint8_t>(handle >> kIndexBits);
+  job.path       = path;
+
+  JobSystem::Get().Run(
+      "DecodeTexture",
+      [this, job]() mutable {
+        decode(job);
+        std::lock_guard<std::mutex> lock(mutex_);
+        decoded_.push_back(std::move(job));
+      },
+      &decode_jobs_);
+}
+
+TextureHandle AssetManager::FindTexture(UUID uuid) const {
+  auto it = uuids_.find(uuid);
+  return it == uuids_.end() ? kInvalidHandle : it->second;
+}
+
+TextureHandle AssetManager::AddTexture(const std::shared_ptr<Texture> &texture) {
+  if (!texture) return kInvalidHandle;
+
+  TextureHandle handle = allocate(s_empty_path, UUID());
+  Slot         *slot   = get_slot(handle);
+  slot->texture        = texture;
+  slot->state          = State::Ready;
+  return handle;
+}
+
+void AssetManager::Acquire(TextureHandle handle, uint32_t count) {
+  if (Slot *slot = get_slot(handle)) slot->references += count;
+}
+
+void AssetManager::Release(TextureHandle handle) {
+  Slot *slot = get_slot(handle);
+  if (!slot || --slot->references > 0) return;
+
+  if (!slot->path.empty()) paths_.erase(slot->path);
+  uuids_.erase(slot->uuid);
+  if (slot->texture) graveyard_.push_back(std::move(slot->texture));
+  slot->texture.reset();
+  slot->path.clear();
+
+  // Generation 0 is skipped so that no live handle is ever equal to kInvalidHandle.
+  slot->generation = slot->generation == 255 ? 1 : slot->generation + 1;
+  free_slots_.push_back(handle & kIndexMask);
+}
+
+void AssetManager::ReleaseLater(TextureHandle handle) {
+  if (handle == kInvalidHandle) return;
+  std::lock_guard<std::mutex> lock(release_mutex_);
+  pending_releases_.push_back(handle);
+}
+
+const Texture *AssetManager::ResolveTexture(TextureHandle handle) const {
+  const Slot *slot = get_slot(handle);
+  if (!slot) return nullptr;
+  return slot->state == State::Ready ? slot->texture.get() : placeholder_.get();
+}
+
+AssetManager::State AssetManager::GetState(TextureHandle handle) const {
+  const Slot *slot = get_slot(handle);
+  return slot ? slot->state : State::Failed;
+}
+
+UUID AssetManager::GetUUID(TextureHandle handle) const {
+  const Slot *slot = get_slot(handle);
+  return slot ? slot->uuid : UUID(0);
+}
+
+const std::string &AssetManager::GetPath(TextureHandle handle) const {
+  const Slot *slot = get_slot(handle);
+  return slot ? slot->path : s_empty_path;
+}
+
+void AssetManager::decode(DecodeJob &job) {
+  job.pixels = stbi_load(job.path.c_str(), &job.width, &job.height, &job.channels, 0);
+  if (!job.pixels) return;
+
+  // Flipped by hand, stbi_set_flip_vertically_on_load is global state shared with the other threads.
+  size_t                     stride = static_cast<size_t>(job.width) * job.channels;
+  std::vector<unsigned char> row(stride);
+  for (int y = 0; y < job.height / 2; y++) {
+    unsigned char *top    = job.pixels + y * stride;
+    unsigned char *bottom = job.pixels + (job.height - 1 - y) * stride;
+    std::memcpy(row.data(), top, stride);
+    std::memcpy(top, bottom, stride);
+    std::memcpy(bottom, row.data(), stride);
+  }
+}
+
+void AssetManager::create_placeholder() {
+  // Magenta and black checkerboard, hard to mistake for real art.
+  static unsigned char pixels[2 * 2 * 4] = {
+      255, 0, 255, 255, 0, 0, 0, 255, 0, 0, 0, 255, 255, 0, 255, 255,
+  };
+  placeholder_ = std::make_shared<Texture>();
+  placeholder_->SetData(pixels, 2, 2, 4);
+}
+
+void AssetManager::Update(float budget_ms) {
+  using Clock = std::chrono::steady_clock;
+
+  if (!placeholder_) create_placeholder();
+  graveyard_.clear();
+
+  std::vector<TextureHandle> releases;
+  {
+    std::lock_guard<std::mutex> lock(release_mutex_);
+    releases.swap(pending_releases_);
+  }
+  for (auto handle : releases) {
+    Release(handle);
+  }
+
+  stats_ = Statistics();
+
+  auto start = Clock::now();
+  bool spent = false;
+  while (!spent) {
+    DecodeJob job;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (decoded_.empty()) break;
+      job = std::move(decoded_.front());
+      decoded_.pop_front();
+    }
+
+    Slot *slot = get_slot(make_handle(job.index, job.generation));
+    if (!slot) {
+      // Released while it was being decoded.
+      stbi_image_free(job.pixels);
+      continue;
+    }
+
+    if (job.pixels) {
+      auto texture = std::make_shared<Texture>();
+      texture->SetData(job.pixels, job.width, job.height, job.channels);
+      stbi_image_free(job.pixels);
+      slot->texture = texture;
+      slot->state   = State::Ready;
+      stats_.uploaded++;
+    } else {
+      logger_->error("Failed to load texture: {0}", job.path);
+      slot->state = State::Failed;
+    }
+
+    spent = std::chrono::duration<float, std::milli>(Clock::now() - start).count() >= budget_ms;
+  }
+
+  for (const auto &slot : slots_) {
+    if (slot.references == 0) continue;
+    if (slot.state == State::Loading) stats_.loading++;
+    if (slot.state == State::Ready) stats_.ready++;
+    if (slot.state == State::Failed) stats_.failed++;
+  }
+}
+
+void AssetManager::Shutdown() {
+  // The queued decodes capture `this`, let them finish before their results are dropped.
+  JobSystem::Get().Wait(decode_jobs_);
+
+  for (auto &job : decoded_) {
+    stbi_image_free(job.pixels);
+  }
+  decoded_.clear();
+  pending_releases_.clear();
+
+  slots_.clear();
+  free_slots_.clear();
+  paths_.clear();
+  uuids_.clear();
+  graveyard_.clear();
+  placeholder_.reset();
+}
+
+}  // namespace MEngine
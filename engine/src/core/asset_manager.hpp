@@ -0,0 +1,227 @@
+/**
+ * @file asset_manager.hpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2024-08-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/job_system.hpp"
+#include "core/logger.hpp"
+#include "core/uuid.hpp"
+#include "render/texture.hpp"
+
+namespace MEngine {
+
+/**
+ * @brief Loads textures in the background and hands out generational handles.
+ *
+ * LoadTexture() returns at once. A job on the JobSystem decodes the file, and Update(),
+ * called on the render thread, uploads the decoded pixels within a time budget.
+ * Until then the handle resolves to a placeholder texture. Loading the same
+ * path or UUID again returns the same handle and adds a reference; the texture
+ * is freed when the last reference is released.
+ *
+ * Handles pack a 24-bit slot index with an 8-bit generation, so handles to a
+ * released slot stop resolving instead of aliasing the next texture there.
+ *
+ * Everything except the decoding and ReleaseLater() runs on the thread that owns the GL context.
+ *
+ */
+class AssetManager {
+ public:
+  static constexpr TextureHandle kInvalidHandle = 0;
+
+  enum class State : uint8_t {
+    // Known by path and UUID only, from ReferenceTexture(). Decoded once LoadTexture() asks for it.
+    Unloaded,
+    Loading,
+    Ready,
+    Failed,
+  };
+
+  /**
+   * @brief Counters of the texture slots, `uploaded` covers the last Update().
+   *
+   */
+  struct Statistics {
+    uint32_t loading  = 0;
+    uint32_t ready    = 0;
+    uint32_t failed   = 0;
+    uint32_t uploaded = 0;
+  };
+
+  static AssetManager &Get();
+
+  /**
+   * @brief Handle of the texture at `path`, queued for loading the first time the path is seen.
+   *
+   */
+  TextureHandle LoadTexture(const std::string &path);
+
+  /**
+   * @brief Same as LoadTexture(path), but the asset is known by `uuid` (e.g. when read back from a scene file).
+   *
+   */
+  TextureHandle LoadTexture(const std::string &path, UUID uuid);
+
+  /**
+   * @brief Handle that carries `path` and `uuid` without decoding the file, for tools that only
+   * move scenes around. Resolves to the placeholder until a LoadTexture() of the same path.
+   *
+   */
+  TextureHandle ReferenceTexture(const std::string &path, UUID uuid);
+
+  /**
+   * @brief Handle of an already loaded asset, or kInvalidHandle. Does not add a reference.
+   *
+   */
+  TextureHandle FindTexture(UUID uuid) const;
+
+  /**
+   * @brief Take ownership of a texture created elsewhere, it is ready immediately.
+   *
+   */
+  TextureHandle AddTexture(const std::shared_ptr<Texture> &texture);
+
+  /**
+   * @brief Add `count` references at once, e.g. for every copy of a prefab sprite.
+   *
+   */
+  void Acquire(TextureHandle handle, uint32_t count = 1);
+
+  void Release(TextureHandle handle);
+
+  /**
+   * @brief Release() that may be called from any thread, it takes effect on the next Update().
+   *
+   */
+  void ReleaseLater(TextureHandle handle);
+
+  /**
+   * @brief The texture to draw for `handle`: the real one once uploaded, the placeholder while
+   * loading or after a failure, nullptr for kInvalidHandle and stale handles.
+   *
+   */
+  const Texture *ResolveTexture(TextureHandle handle) const;
+
+  bool IsValid(TextureHandle handle) const { return get_slot(handle) != nullptr; }
+
+  State GetState(TextureHandle handle) const;
+
+  UUID GetUUID(TextureHandle handle) const;
+
+  const std::string &GetPath(TextureHandle handle) const;
+
+  /**
+   * @brief Apply the pending ReleaseLater() calls, upload decoded textures until `budget_ms`
+   * is spent (at least one per call) and delete the textures released since the last call.
+   * Render thread only.
+   *
+   */
+  void Update(float budget_ms = 2.0f);
+
+  /**
+   * @brief Wait for the pending decodes and delete every texture, call while the GL context is still alive.
+   *
+   */
+  void Shutdown();
+
+  const Statistics &GetStats() const { return stats_; }
+
+ private:
+  AssetManager();
+  ~AssetManager();
+
+  AssetManager(const AssetManager &)            = delete;
+  AssetManager &operator=(const AssetManager &) = delete;
+
+  static constexpr uint32_t kIndexBits = 24;
+  static constexpr uint32_t kIndexMask = (1u << kIndexBits) - 1;
+
+  struct Slot {
+    std::shared_ptr<Texture> texture;
+    std::string              path;
+    UUID                     uuid{0};
+    uint32_t                 references = 0;
+    uint8_t                  generation = 1;
+    State                    state      = State::Loading;
+  };
+
+  /**
+   * @brief Work handed to and returned from the decode jobs.
+   *
+   */
+  struct DecodeJob {
+    uint32_t       index      = 0;
+    uint8_t        generation = 0;
+    std::string    path;
+    unsigned char *pixels   = nullptr;
+    int            width    = 0;
+    int            height   = 0;
+    int            channels = 0;
+  };
+
+  static TextureHandle make_handle(uint32_t index, uint8_t generation) {
+    return static_cast<TextureHandle>(generation) << kIndexBits | index;
+  }
+
+  Slot *get_slot(TextureHandle handle);
+
+  const Slot *get_slot(TextureHandle handle) const;
+
+  /**
+   * @brief A free slot (or a new one) with one reference, keyed by `uuid`.
+   *
+   */
+  TextureHandle allocate(const std::string &path, UUID uuid);
+
+  /**
+   * @brief Hand the file of `handle` to a decode job.
+   *
+   */
+  void queue_decode(TextureHandle handle, const std::string &path);
+
+  static void decode(DecodeJob &job);
+
+  void create_placeholder();
+
+  std::vector<Slot>     slots_;
+  std::vector<uint32_t> free_slots_;
+
+  std::unordered_map<std::string, TextureHandle> paths_;
+  std::unordered_map<UUID, TextureHandle>        uuids_;
+
+  // Released textures are kept until the next Update() so a frame in flight never loses them.
+  std::vector<std::shared_ptr<Texture>> graveyard_;
+
+  std::shared_ptr<Texture> placeholder_;
+
+  // Decode jobs push their results here, Update() takes them on the render thread.
+  std::mutex            mutex_;
+  std::deque<DecodeJob> decoded_;
+  JobSystem::Counter    decode_jobs_;
+
+  // Handles from ReleaseLater(), released at the start of the next Update().
+  std::mutex                 release_mutex_;
+  std::vector<TextureHandle> pending_releases_;
+
+  Statistics stats_;
+
+  std::shared_ptr<spdlog::logger> logger_;
+};
+
+}  // namespace MEngine
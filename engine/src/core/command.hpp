@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <memory>
 #include <string>
@@ -24,6 +25,7 @@ class VertexArray;
 };
 
 class Shader;
+class Texture;
 
 /**
  * @brief Command class is a utility class for parsing command line arguments.
@@ -54,31 +56,19 @@ class Command {
   bool is_cancelled_;
 };
 
-class RenderCommand : public Command {
- public:
-  RenderCommand() : Command(Type::Render) {}
-
-  ~RenderCommand() {}
-
-  void SetRenderInfo(const Sprite2D &render_info) { render_info_ = render_info; }
-
-  Sprite2D &GetRenderInfo() { return render_info_; }
-
-  void SetModelMatrix(const glm::mat4 &model_matrix) { model_matrix_ = model_matrix; }
-
-  void SetViewProjectionMatrix(const glm::mat4 &view_projection_matrix) {
-    view_projection_matrix_ = view_projection_matrix;
-  }
-
-  const glm::mat4 &GetModelMatrix() const { return model_matrix_; }
-
-  const glm::mat4 &GetProjectionView() const { return view_projection_matrix_; }
+/**
+ * @brief One quad to draw, ordered by its 64-bit sort key in the RenderQueue.
+ * A plain value, the queue copies thousands of them per frame.
+ *
+ */
+struct RenderCommand {
+  uint64_t sort_key = 0;
 
- private:
-  Sprite2D render_info_;
+  glm::mat4 model_matrix = glm::mat4(1.0f);
+  glm::vec4 color        = glm::vec4(1.0f);
+  glm::vec4 uv_rect      = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
 
-  glm::mat4 model_matrix_;
-  glm::mat4 view_projection_matrix_;
+  TextureHandle texture = 0;
 };
 
 class MoveCommand : public Command {
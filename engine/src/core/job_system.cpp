@@ -0,0 +1,236 @@
+#include "core/job_system.hpp"
+
+#include <chrono>
+#include <limits>
+
+namespace MEngine {
+
+static constexpr uint32_t kForeignThread = std::numeric_limits<uint32_t>::max();
+
+// Index of the calling thread in the queues of the job system, foreign threads have none.
+static thread_local uint32_t s_thread_index = kForeignThread;
+
+static uint64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+JobSystem &JobSystem::Get() {
+  static JobSystem system;
+  return system;
+}
+
+JobSystem::JobSystem() { logger_ = Logger::Get("JobSystem"); }
+
+JobSystem::~JobSystem() { Shutdown(); }
+
+void JobSystem::Initialize(unsigned int worker_count) {
+  if (!queues_.empty()) return;
+
+  if (worker_count == 0) worker_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+  stopping_ = false;
+  for (unsigned int i = 0; i <= worker_count; i++) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+
+  s_thread_index = 0;
+  for (uint32_t thread = 1; thread <= worker_count; thread++) {
+    workers_.emplace_back(&JobSystem::worker_loop, this, thread);
+  }
+  logger_->info("Started {} job worker threads", worker_count);
+}
+
+void JobSystem::Shutdown() {
+  if (queues_.empty()) return;
+
+  // Let the queued jobs finish, this thread helps.
+  uint32_t thread = current_thread();
+  while (queued_.load() > 0 || waiting_count_.load() > 0) {
+    if (!try_execute(thread)) std::this_thread::yield();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stopping_ = true;
+  }
+  sleep_condition_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+  queues_.clear();
+  s_thread_index = kForeignThread;
+}
+
+uint32_t JobSystem::current_thread() const { return s_thread_index; }
+
+void JobSystem::Run(const char *name, JobFunction function, Counter *counter, const Counter *dependency) {
+  if (counter) counter->value.fetch_add(1, std::memory_order_relaxed);
+
+  Job job;
+  job.function = std::move(function);
+  job.name     = name;
+  job.counter  = counter;
+
+  if (queues_.empty()) {
+    execute(kForeignThread, job);
+    return;
+  }
+
+  if (dependency) {
+    // Announced before the check, so a thread finishing the dependency either sees this job or we see zero.
+    waiting_count_.fetch_add(1);
+    {
+      std::lock_guard<std::mutex> lock(waiting_mutex_);
+      if (dependency->value.load() != 0) {
+        waiting_[dependency].push_back(std::move(job));
+        return;
+      }
+    }
+    waiting_count_.fetch_sub(1);
+  }
+
+  push_job(std::move(job));
+}
+
+void JobSystem::push_job(Job &&job) {
+  // Foreign threads spread their jobs over the queues of the pool.
+  uint32_t thread = current_thread();
+  if (thread >= queues_.size()) thread = next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+  {
+    std::lock_guard<std::mutex> lock(queues_[thread]->mutex);
+    queues_[thread]->jobs.push_back(std::move(job));
+  }
+  queued_.fetch_add(1);
+
+  // Paired with the sleeping_ increment in worker_loop(): either the worker sees the job or we see the sleeper.
+  if (sleeping_.load() > 0) {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    sleep_condition_.notify_one();
+  }
+}
+
+void JobSystem::release_dependents(const Counter *counter) {
+  std::vector<Job> jobs;
+  {
+    std::lock_guard<std::mutex> lock(waiting_mutex_);
+    auto                        it = waiting_.find(counter);
+    if (it == waiting_.end()) return;
+    jobs = std::move(it->second);
+    waiting_.erase(it);
+  }
+
+  for (auto &job : jobs) {
+    push_job(std::move(job));
+  }
+  waiting_count_.fetch_sub(static_cast<uint32_t>(jobs.size()));
+}
+
+void JobSystem::Wait(const Counter &counter) {
+  uint32_t thread = current_thread();
+  while (!counter.IsDone()) {
+    if (!queues_.empty() && try_execute(thread)) continue;
+    std::this_thread::yield();
+  }
+}
+
+bool JobSystem::try_get_job(uint32_t thread, Job &job) {
+  const size_t count = queues_.size();
+
+  // Own work first, newest job first while it is still in cache.
+  if (thread < count) {
+    Queue                      &own = *queues_[thread];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.jobs.empty()) {
+      job = std::move(own.jobs.back());
+      own.jobs.pop_back();
+      queued_.fetch_sub(1);
+      return true;
+    }
+  }
+
+  // Steal the oldest job of another thread, busy queues are skipped instead of waited on.
+  uint32_t start = thread < count ? thread + 1 : 0;
+  for (size_t i = 0; i < count; i++) {
+    uint32_t victim_index = static_cast<uint32_t>((start + i) % count);
+    if (victim_index == thread) continue;
+
+    Queue                       &victim = *queues_[victim_index];
+    std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || victim.jobs.empty()) continue;
+
+    job = std::move(victim.jobs.front());
+    victim.jobs.pop_front();
+    queued_.fetch_sub(1);
+    if (thread < count) queues_[thread]->stolen.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
+}
+
+bool JobSystem::try_execute(uint32_t thread) {
+  Job job;
+  if (!try_get_job(thread, job)) return false;
+
+  execute(thread, job);
+  return true;
+}
+
+void JobSystem::execute(uint32_t thread, Job &job) {
+  uint64_t start = now_ns();
+  job.function();
+  uint64_t end = now_ns();
+
+  if (thread < queues_.size()) {
+    queues_[thread]->executed.fetch_add(1, std::memory_order_relaxed);
+    queues_[thread]->busy_ns.fetch_add(end - start, std::memory_order_relaxed);
+  }
+  if (profile_hook_) profile_hook_(ProfileEvent{job.name, thread, start, end});
+
+  if (job.counter && job.counter->value.fetch_sub(1) == 1 && waiting_count_.load() > 0) {
+    release_dependents(job.counter);
+  }
+}
+
+void JobSystem::worker_loop(uint32_t thread) {
+  s_thread_index = thread;
+
+  while (true) {
+    if (try_execute(thread)) continue;
+
+    if (queued_.load() > 0) {
+      // The queues holding the jobs were locked by other threads, try again.
+      std::this_thread::yield();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    sleeping_.fetch_add(1);
+    sleep_condition_.wait(lock, [this] { return stopping_ || queued_.load() > 0; });
+    sleeping_.fetch_sub(1);
+    if (stopping_ && queued_.load() == 0) return;
+  }
+}
+
+std::vector<JobSystem::ThreadStatistics> JobSystem::GetStats() const {
+  std::vector<ThreadStatistics> stats(queues_.size());
+  for (size_t i = 0; i < queues_.size(); i++) {
+    stats[i].jobs    = queues_[i]->executed.load(std::memory_order_relaxed);
+    stats[i].stolen  = queues_[i]->stolen.load(std::memory_order_relaxed);
+    stats[i].busy_ns = queues_[i]->busy_ns.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+void JobSystem::ResetStats() {
+  for (auto &queue : queues_) {
+    queue->executed = 0;
+    queue->stolen   = 0;
+    queue->busy_ns  = 0;
+  }
+}
+
+}  // namespace MEngine
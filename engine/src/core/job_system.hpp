@@ -0,0 +1,219 @@
+/**
+ * @file job_system.hpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2024-08-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "core/logger.hpp"
+
+namespace MEngine {
+
+/**
+ * @brief Fixed pool of worker threads running small jobs.
+ *
+ * Every thread (the workers and the thread that called Initialize()) owns a
+ * deque: it pushes and pops its own jobs at the back, idle threads steal from
+ * the front of the others. Jobs report completion through a Counter, and
+ * Wait() keeps executing jobs instead of blocking, so waiting inside a job is fine.
+ * A job with a dependency is held back until that counter reaches zero and is
+ * queued by whichever thread finishes the last job of it.
+ *
+ * Without Initialize() (or with 0 workers) jobs simply run on the calling thread.
+ *
+ */
+class JobSystem {
+ public:
+  /**
+   * @brief Number of unfinished jobs of a group, Run() increments it and the job decrements it when done.
+   *
+   */
+  struct Counter {
+    std::atomic<uint32_t> value{0};
+
+    bool IsDone() const { return value.load(std::memory_order_acquire) == 0; }
+  };
+
+  using JobFunction = std::function<void()>;
+
+  /**
+   * @brief One executed job as seen by the profiling hook, times are steady_clock nanoseconds.
+   *
+   */
+  struct ProfileEvent {
+    const char *name;
+    uint32_t    thread;
+    uint64_t    start;
+    uint64_t    end;
+  };
+
+  using ProfileHook = std::function<void(const ProfileEvent &)>;
+
+  /**
+   * @brief Per-thread counters since the last ResetStats(), index 0 is the thread that called Initialize().
+   *
+   */
+  struct ThreadStatistics {
+    uint64_t jobs    = 0;
+    uint64_t stolen  = 0;
+    uint64_t busy_ns = 0;
+  };
+
+  static JobSystem &Get();
+
+  /**
+   * @brief Start `worker_count` workers, or one per remaining hardware thread when 0.
+   * The calling thread becomes thread 0 and takes part in Wait().
+   *
+   */
+  void Initialize(unsigned int worker_count = 0);
+
+  /**
+   * @brief Finish the queued jobs and join the workers.
+   *
+   */
+  void Shutdown();
+
+  /**
+   * @brief Threads that execute jobs, including the calling thread.
+   *
+   */
+  unsigned int GetThreadCount() const { return static_cast<unsigned int>(queues_.size()); }
+
+  /**
+   * @brief Queue `function`. If `dependency` is given the job does not start before it reaches zero.
+   *
+   */
+  void Run(const char *name, JobFunction function, Counter *counter = nullptr, const Counter *dependency = nullptr);
+
+  /**
+   * @brief Execute jobs on the calling thread until `counter` reaches zero.
+   *
+   */
+  void Wait(const Counter &counter);
+
+  /**
+   * @brief Call `func(begin, end)` over [0, count) in chunks of at least `min_batch`
+   * items spread over every thread, and return once all chunks are done.
+   *
+   */
+  template <typename Func>
+  void ParallelFor(const char *name, size_t count, size_t min_batch, Func func) {
+    if (count == 0) return;
+
+    size_t chunks = std::min<size_t>(GetThreadCount() * 4, (count + min_batch - 1) / std::max<size_t>(min_batch, 1));
+    if (chunks <= 1) {
+      func(size_t(0), count);
+      return;
+    }
+
+    Counter counter;
+    // Chunk 0 stays on this thread, the others are up for grabs.
+    for (size_t chunk = 1; chunk < chunks; chunk++) {
+      size_t begin = count * chunk / chunks;
+      size_t end   = count * (chunk + 1) / chunks;
+      Run(name, [&func, begin, end] { func(begin, end); }, &counter);
+    }
+    func(size_t(0), count / chunks);
+    Wait(counter);
+  }
+
+  /**
+   * @brief Called on the executing thread after every job, keep it cheap. Set before submitting jobs.
+   *
+   */
+  void SetProfileHook(ProfileHook hook) { profile_hook_ = std::move(hook); }
+
+  std::vector<ThreadStatistics> GetStats() const;
+
+  void ResetStats();
+
+ private:
+  JobSystem();
+  ~JobSystem();
+
+  JobSystem(const JobSystem &)            = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+
+  struct Job {
+    JobFunction function;
+    const char *name    = nullptr;
+    Counter    *counter = nullptr;
+  };
+
+  struct alignas(64) Queue {
+    std::mutex      mutex;
+    std::deque<Job> jobs;
+
+    std::atomic<uint64_t> executed{0};
+    std::atomic<uint64_t> stolen{0};
+    std::atomic<uint64_t> busy_ns{0};
+  };
+
+  /**
+   * @brief Pop from the own queue, else steal from another one.
+   *
+   */
+  bool try_get_job(uint32_t thread, Job &job);
+
+  void push_job(Job &&job);
+
+  /**
+   * @brief Queue the jobs held back on `counter`, called once it reached zero.
+   *
+   */
+  void release_dependents(const Counter *counter);
+
+  /**
+   * @brief Run one available job, false when there was none.
+   *
+   */
+  bool try_execute(uint32_t thread);
+
+  void execute(uint32_t thread, Job &job);
+
+  void worker_loop(uint32_t thread);
+
+  uint32_t current_thread() const;
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread>            workers_;
+
+  // Sleeping workers wait here until a job is queued.
+  std::mutex              sleep_mutex_;
+  std::condition_variable sleep_condition_;
+  std::atomic<uint32_t>   queued_{0};
+  std::atomic<uint32_t>   sleeping_{0};
+  std::atomic<bool>       stopping_{false};
+
+  std::atomic<uint32_t> next_queue_{0};
+
+  // Jobs whose dependency has not reached zero yet, keyed by that counter.
+  std::mutex                                             waiting_mutex_;
+  std::unordered_map<const Counter *, std::vector<Job>> waiting_;
+  std::atomic<uint32_t>                                  waiting_count_{0};
+
+  ProfileHook profile_hook_;
+
+  std::shared_ptr<spdlog::logger> logger_;
+};
+
+}  // namespace MEngine
@@ -0,0 +1,57 @@
+/**
+ * @file mapped_file.hpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2024-08-21
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace MEngine {
+
+/**
+ * @brief Read-only memory mapping of a whole file. Pages are read in by the OS
+ * on first access, nothing is copied up front.
+ *
+ */
+class MappedFile {
+ public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile &)            = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  /**
+   * @brief Map `path`, false when it does not exist, is empty or can not be mapped.
+   *
+   */
+  bool Open(const std::string &path);
+
+  void Close();
+
+  bool IsOpen() const { return data_ != nullptr; }
+
+  const uint8_t *GetData() const { return data_; }
+
+  size_t GetSize() const { return size_; }
+
+ private:
+  const uint8_t *data_ = nullptr;
+  size_t         size_ = 0;
+
+#if defined(_WIN32)
+  void *file_    = nullptr;
+  void *mapping_ = nullptr;
+#endif
+};
+
+}  // namespace MEngine
@@ -0,0 +1,81 @@
+/**
+ * @file triple_buffer.hpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2024-08-20
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace MEngine {
+
+/**
+ * @brief Lock-free hand over of the latest value from one writer thread to one reader thread.
+ *
+ * The writer fills GetWriteBuffer() and calls Publish(), the reader picks up the
+ * newest published value with Acquire(). Neither side ever waits for the other:
+ * values the reader did not get to in time are overwritten, and the reader keeps
+ * its current value until a newer one is published. Slots are reused, so vectors
+ * inside `T` keep their capacity.
+ *
+ */
+template <typename T>
+class TripleBuffer {
+ public:
+  /**
+   * @brief The slot owned by the writer, it still holds whatever was written three publishes ago.
+   *
+   */
+  T &GetWriteBuffer() { return slots_[back_]; }
+
+  /**
+   * @brief Hand the write buffer to the reader and take the stale slot back in exchange.
+   *
+   */
+  void Publish() { back_ = ready_.exchange(back_ | kFreshBit, std::memory_order_acq_rel) & kIndexMask; }
+
+  /**
+   * @brief The newest published value, or nullptr before the first Publish(). Stays valid until the next call.
+   *
+   */
+  const T *Acquire() {
+    if (ready_.load(std::memory_order_relaxed) & kFreshBit) {
+      front_     = ready_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+      has_front_ = true;
+    }
+    return has_front_ ? &slots_[front_] : nullptr;
+  }
+
+  /**
+   * @brief Forget the published values, only while neither thread uses the buffer.
+   *
+   */
+  void Reset() {
+    back_      = 0;
+    front_     = 1;
+    has_front_ = false;
+    ready_.store(2, std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr uint32_t kIndexMask = 0x3;
+  static constexpr uint32_t kFreshBit  = 0x4;
+
+  T slots_[3];
+
+  uint32_t back_      = 0;  // writer only
+  uint32_t front_     = 1;  // reader only
+  bool     has_front_ = false;
+
+  // Index of the slot in the middle, kFreshBit is set while the reader has not taken it.
+  std::atomic<uint32_t> ready_{2};
+};
+
+}  // namespace MEngine
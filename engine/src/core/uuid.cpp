@@ -9,7 +9,12 @@ static std::random_device                      s_random_device;
 static std::mt19937_64                         s_engine(s_random_device());
 static std::uniform_int_distribution<uint64_t> s_uniform_distribution;
 
-UUID::UUID() : uuid_(s_uniform_distribution(s_engine)) {}
+UUID::UUID() {
+  // 0 stands for "no UUID" (missing textures, empty UUIDMap slots), draw again in the unlikely case.
+  do {
+    uuid_ = s_uniform_distribution(s_engine);
+  } while (uuid_ == 0);
+}
 
 UUID::UUID(uint64_t uuid) : uuid_(uuid) {}
 
@@ -0,0 +1,164 @@
+/**
+ * @file uuid_map.hpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2024-08-23
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/uuid.hpp"
+
+namespace MEngine {
+
+/**
+ * @brief Hash map from UUID to a small trivially copyable `Value`, stored in one flat array.
+ *
+ * Open addressing with linear probing: a lookup hashes once and scans neighbouring
+ * slots, which usually share a cache line, and inserting never allocates a node.
+ * Erase shifts the following entries back instead of leaving tombstones, so probe
+ * sequences stay short under churn. The table doubles when it is 70% full.
+ *
+ * UUID 0 marks empty slots and can not be stored, UUID() never generates it.
+ *
+ */
+template <typename Value>
+class UUIDMap {
+ public:
+  UUIDMap() = default;
+
+  /**
+   * @brief Make room for `count` entries without growing in between.
+   *
+   */
+  void Reserve(size_t count) {
+    size_t capacity = kMinCapacity;
+    while (capacity * kMaxLoadPercent / 100 < count) capacity *= 2;
+    if (capacity > slots_.size()) rehash(capacity);
+  }
+
+  /**
+   * @brief Add `uuid` or overwrite its value, true when it was not present before.
+   *
+   */
+  bool Insert(UUID uuid, Value value) {
+    uint64_t key = uuid;
+    if (key == kEmpty) return false;
+    if ((size_ + 1) * 100 > slots_.size() * kMaxLoadPercent) rehash(slots_.empty() ? kMinCapacity : slots_.size() * 2);
+
+    for (size_t i = home(key);; i = (i + 1) & mask_) {
+      Slot &slot = slots_[i];
+      if (slot.key == key) {
+        slot.value = value;
+        return false;
+      }
+      if (slot.key == kEmpty) {
+        slot.key   = key;
+        slot.value = value;
+        size_++;
+        return true;
+      }
+    }
+  }
+
+  /**
+   * @brief The value of `uuid`, nullptr when it is not in the map.
+   *
+   */
+  const Value *Find(UUID uuid) const {
+    uint64_t key = uuid;
+    if (size_ == 0 || key == kEmpty) return nullptr;
+
+    for (size_t i = home(key);; i = (i + 1) & mask_) {
+      const Slot &slot = slots_[i];
+      if (slot.key == key) return &slot.value;
+      if (slot.key == kEmpty) return nullptr;
+    }
+  }
+
+  bool Contains(UUID uuid) const { return Find(uuid) != nullptr; }
+
+  /**
+   * @brief Remove `uuid`, false when it was not in the map.
+   *
+   */
+  bool Erase(UUID uuid) {
+    uint64_t key = uuid;
+    if (size_ == 0 || key == kEmpty) return false;
+
+    size_t hole = home(key);
+    while (slots_[hole].key != key) {
+      if (slots_[hole].key == kEmpty) return false;
+      hole = (hole + 1) & mask_;
+    }
+
+    // Move later entries of the cluster into the hole when that does not put them before their home slot.
+    for (size_t i = (hole + 1) & mask_; slots_[i].key != kEmpty; i = (i + 1) & mask_) {
+      size_t ideal = home(slots_[i].key);
+      if (((i - ideal) & mask_) >= ((i - hole) & mask_)) {
+        slots_[hole] = slots_[i];
+        hole         = i;
+      }
+    }
+    slots_[hole].key = kEmpty;
+    size_--;
+    return true;
+  }
+
+  void Clear() {
+    for (auto &slot : slots_) {
+      slot.key = kEmpty;
+    }
+    size_ = 0;
+  }
+
+  size_t Size() const { return size_; }
+
+  size_t GetCapacity() const { return slots_.size(); }
+
+ private:
+  static constexpr uint64_t kEmpty          = 0;
+  static constexpr size_t   kMinCapacity    = 16;
+  static constexpr size_t   kMaxLoadPercent = 70;
+
+  struct Slot {
+    uint64_t key = kEmpty;
+    Value    value{};
+  };
+
+  /**
+   * @brief Fibonacci hashing, spreads sequential UUIDs (tests, hand written files) as well as random ones.
+   *
+   */
+  size_t home(uint64_t key) const { return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_); }
+
+  void rehash(size_t capacity) {
+    std::vector<Slot> old = std::move(slots_);
+    slots_.assign(capacity, Slot());
+    mask_  = capacity - 1;
+    shift_ = 64;
+    for (size_t c = capacity; c > 1; c >>= 1) shift_--;
+
+    for (const auto &slot : old) {
+      if (slot.key == kEmpty) continue;
+      size_t i = home(slot.key);
+      while (slots_[i].key != kEmpty) i = (i + 1) & mask_;
+      slots_[i] = slot;
+    }
+  }
+
+  std::vector<Slot> slots_;
+  size_t            size_  = 0;
+  size_t            mask_  = 0;
+  uint32_t          shift_ = 64;
+};
+
+}  // namespace MEngine
@@ -2,6 +2,8 @@
 
 #include <glad/glad.h>
 
+#include "render/render_state.hpp"
+
 namespace MEngine {
 
 FrameBuffer::FrameBuffer() {
@@ -12,16 +14,19 @@ FrameBuffer::FrameBuffer() {
   glGenFramebuffers(1, &id_);
 }
 
-FrameBuffer::~FrameBuffer() { glDeleteFramebuffers(1, &id_); }
+FrameBuffer::~FrameBuffer() {
+  RenderState::OnDeleteFramebuffer(id_);
+  glDeleteFramebuffers(1, &id_);
+}
 
-void FrameBuffer::Bind() const { glBindFramebuffer(GL_FRAMEBUFFER, id_); }
+void FrameBuffer::Bind() const { RenderState::BindFramebuffer(id_); }
 
-void FrameBuffer::Unbind() const { glBindFramebuffer(GL_FRAMEBUFFER, 0); }
+void FrameBuffer::Unbind() const { RenderState::BindFramebuffer(0); }
 
 void FrameBuffer::AttachTexture() {
   Bind();
   glGenTextures(1, &texture_id_);
-  glBindTexture(GL_TEXTURE_2D, texture_id_);
+  RenderState::BindTexture(0, texture_id_);
   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width_, height_, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -49,6 +54,7 @@ void FrameBuffer::Resize(int width, int height) {
   width_  = width;
   height_ = height;
 
+  RenderState::OnDeleteTexture(texture_id_);
   glDeleteTextures(1, &texture_id_);
   glDeleteRenderbuffers(1, &render_buffer_id_);
   glViewport(0, 0, width, height);
@@ -2,81 +2,244 @@
 
 #include <glad/glad.h>
 
+#include "render/render_state.hpp"
+
 namespace MEngine {
 
 namespace GL {
 
+unsigned int ShaderDataTypeSize(ShaderDataType type) {
+  switch (type) {
+    case ShaderDataType::Float:
+    case ShaderDataType::Int:
+    case ShaderDataType::Bool:
+      return 4;
+    case ShaderDataType::Float2:
+    case ShaderDataType::Int2:
+      return 4 * 2;
+    case ShaderDataType::Float3:
+    case ShaderDataType::Int3:
+      return 4 * 3;
+    case ShaderDataType::Float4:
+    case ShaderDataType::Int4:
+      return 4 * 4;
+    case ShaderDataType::Mat3:
+      return 4 * 3 * 3;
+    case ShaderDataType::Mat4:
+      return 4 * 4 * 4;
+  }
+  return 0;
+}
+
+unsigned int ShaderDataTypeComponentCount(ShaderDataType type) {
+  switch (type) {
+    case ShaderDataType::Float:
+    case ShaderDataType::Int:
+    case ShaderDataType::Bool:
+      return 1;
+    case ShaderDataType::Float2:
+    case ShaderDataType::Int2:
+      return 2;
+    case ShaderDataType::Float3:
+    case ShaderDataType::Int3:
+      return 3;
+    case ShaderDataType::Float4:
+    case ShaderDataType::Int4:
+      return 4;
+    case ShaderDataType::Mat3:
+      return 3 * 3;
+    case ShaderDataType::Mat4:
+      return 4 * 4;
+  }
+  return 0;
+}
+
 VertexBuffer::VertexBuffer() { glGenBuffers(1, &id_); }
 
-VertexBuffer::~VertexBuffer() { glDeleteBuffers(1, &id_); }
+VertexBuffer::VertexBuffer(size_t size) {
+  glGenBuffers(1, &id_);
+  Bind();
+  glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+}
+
+VertexBuffer::~VertexBuffer() {
+  RenderState::OnDeleteBuffer(id_);
+  glDeleteBuffers(1, &id_);
+}
 
-void VertexBuffer::Bind() const { glBindBuffer(GL_ARRAY_BUFFER, id_); }
+void VertexBuffer::Bind() const { RenderState::BindBuffer(GL_ARRAY_BUFFER, id_); }
 
-void VertexBuffer::Unbind() const { glBindBuffer(GL_ARRAY_BUFFER, 0); }
+void VertexBuffer::Unbind() const { RenderState::BindBuffer(GL_ARRAY_BUFFER, 0); }
 
 void VertexBuffer::SetData(const void *data, size_t size) {
   Bind();
   glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
 }
 
+void VertexBuffer::SetSubData(const void *data, size_t size, size_t offset) {
+  Bind();
+  glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+}
+
 void VertexBuffer::AddLayout(const std::vector<ElementLayout> &layouts) { layouts_ = layouts; }
 
-void VertexBuffer::SetLayout() {
+unsigned int VertexBuffer::GetStride() const {
+  unsigned int stride = 0;
+  for (const auto &layout : layouts_) {
+    stride += ShaderDataTypeSize(layout.type);
+  }
+  return stride;
+}
+
+unsigned int VertexBuffer::SetLayout(unsigned int first_index) {
   Bind();
-  unsigned int index  = 0;
+  unsigned int index  = first_index;
   size_t       offset = 0;
-  unsigned int stride = 0;
+  unsigned int stride = GetStride();
   for (const auto &layout : layouts_) {
     switch (layout.type) {
       case ShaderDataType::Float:
-        stride += 1 * sizeof(float);
-        break;
       case ShaderDataType::Float2:
-        stride += 2 * sizeof(float);
-        break;
       case ShaderDataType::Float3:
-        stride += 3 * sizeof(float);
-        break;
       case ShaderDataType::Float4:
-        stride += 4 * sizeof(float);
+        glEnableVertexAttribArray(index);
+        glVertexAttribPointer(index, ShaderDataTypeComponentCount(layout.type), GL_FLOAT, GL_FALSE, stride,
+                              (const void *)offset);
+        glVertexAttribDivisor(index, layout.divisor);
+        index++;
         break;
-      default:
+      case ShaderDataType::Int:
+      case ShaderDataType::Int2:
+      case ShaderDataType::Int3:
+      case ShaderDataType::Int4:
+      case ShaderDataType::Bool:
+        glEnableVertexAttribArray(index);
+        glVertexAttribIPointer(index, ShaderDataTypeComponentCount(layout.type), GL_INT, stride,
+                               (const void *)offset);
+        glVertexAttribDivisor(index, layout.divisor);
+        index++;
         break;
+      case ShaderDataType::Mat3:
+      case ShaderDataType::Mat4: {
+        // A matrix attribute occupies one location per column.
+        unsigned int columns = layout.type == ShaderDataType::Mat3 ? 3 : 4;
+        for (unsigned int i = 0; i < columns; i++) {
+          glEnableVertexAttribArray(index);
+          glVertexAttribPointer(index, columns, GL_FLOAT, GL_FALSE, stride,
+                                (const void *)(offset + sizeof(float) * columns * i));
+          glVertexAttribDivisor(index, layout.divisor);
+          index++;
+        }
+        break;
+      }
     }
+    offset += ShaderDataTypeSize(layout.type);
   }
-  for (const auto &layout : layouts_) {
-    glEnableVertexAttribArray(index);
-    switch (layout.type) {
-      case ShaderDataType::Float:
-        glVertexAttribPointer(index, 1, GL_FLOAT, GL_FALSE, stride, (const void *)offset);
-        offset += sizeof(float);
-        break;
-      case ShaderDataType::Float2:
-        glVertexAttribPointer(index, 2, GL_FLOAT, GL_FALSE, stride, (const void *)offset);
-        offset += 2 * sizeof(float);
-        break;
-      case ShaderDataType::Float3:
-        glVertexAttribPointer(index, 3, GL_FLOAT, GL_FALSE, stride, (const void *)offset);
-        offset += 3 * sizeof(float);
-        break;
-      case ShaderDataType::Float4:
-        glVertexAttribPointer(index, 4, GL_FLOAT, GL_FALSE, stride, (const void *)offset);
-        offset += 4 * sizeof(float);
-        break;
-      default:
-        break;
+  return index;
+}
+
+StreamBuffer::StreamBuffer(size_t region_size, unsigned int region_count)
+    : region_size_(region_size), region_count_(region_count), region_(0), head_(0), reserved_(0) {
+  size_t     total = region_size_ * region_count_;
+  GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+  Bind();
+  glBufferStorage(GL_ARRAY_BUFFER, total, nullptr, flags);
+  mapped_ = static_cast<unsigned char *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, total, flags));
+
+  fences_.resize(region_count_, nullptr);
+}
+
+StreamBuffer::~StreamBuffer() {
+  for (void *fence : fences_) {
+    if (fence) glDeleteSync(static_cast<GLsync>(fence));
+  }
+  Bind();
+  glUnmapBuffer(GL_ARRAY_BUFFER);
+}
+
+StreamBuffer::Allocation StreamBuffer::Reserve(size_t size, size_t alignment) {
+  if (size > region_size_) return {nullptr, 0};
+
+  size_t base    = region_ * region_size_;
+  size_t offset  = (base + head_ + alignment - 1) / alignment * alignment;
+  size_t aligned = offset - base;
+  if (aligned + size > region_size_) {
+    next_region();
+    base    = region_ * region_size_;
+    offset  = (base + alignment - 1) / alignment * alignment;
+    aligned = offset - base;
+    if (aligned + size > region_size_) return {nullptr, 0};
+  }
+
+  head_     = aligned;
+  reserved_ = size;
+  return {mapped_ + offset, offset};
+}
+
+void StreamBuffer::Commit(size_t size) {
+  head_ += size < reserved_ ? size : reserved_;
+  reserved_ = 0;
+}
+
+StreamBuffer::Allocation StreamBuffer::Allocate(size_t size, size_t alignment) {
+  Allocation allocation = Reserve(size, alignment);
+  if (allocation.data) Commit(size);
+  return allocation;
+}
+
+void StreamBuffer::EndFrame() {
+  if (head_ > 0) next_region();
+}
+
+void StreamBuffer::next_region() {
+  fences_[region_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  region_   = (region_ + 1) % region_count_;
+  head_     = 0;
+  reserved_ = 0;
+
+  GLsync fence = static_cast<GLsync>(fences_[region_]);
+  if (!fence) return;
+
+  GLenum result = glClientWaitSync(fence, 0, 0);
+  if (result == GL_TIMEOUT_EXPIRED) {
+    stall_count_++;
+    while (result == GL_TIMEOUT_EXPIRED) {
+      result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
     }
-    index++;
   }
+  glDeleteSync(fence);
+  fences_[region_] = nullptr;
+}
+
+UniformBuffer::UniformBuffer(size_t size, unsigned int binding) : binding_(binding) {
+  glGenBuffers(1, &id_);
+  RenderState::BindBuffer(GL_UNIFORM_BUFFER, id_);
+  glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+  RenderState::BindBufferBase(GL_UNIFORM_BUFFER, binding_, id_);
+}
+
+UniformBuffer::~UniformBuffer() {
+  RenderState::OnDeleteBuffer(id_);
+  glDeleteBuffers(1, &id_);
+}
+
+void UniformBuffer::SetData(const void *data, size_t size, size_t offset) {
+  RenderState::BindBuffer(GL_UNIFORM_BUFFER, id_);
+  glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
 }
 
 IndexBuffer::IndexBuffer() { glGenBuffers(1, &id_); }
 
-IndexBuffer::~IndexBuffer() { glDeleteBuffers(1, &id_); }
+IndexBuffer::~IndexBuffer() {
+  RenderState::OnDeleteBuffer(id_);
+  glDeleteBuffers(1, &id_);
+}
 
-void IndexBuffer::Bind() const { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id_); }
+void IndexBuffer::Bind() const { RenderState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, id_); }
 
-void IndexBuffer::Unbind() const { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); }
+void IndexBuffer::Unbind() const { RenderState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); }
 
 void IndexBuffer::SetData(const unsigned int *data, int count) {
   Bind();
@@ -86,17 +249,26 @@ void IndexBuffer::SetData(const unsigned int *data, int count) {
 
 VertexArray::VertexArray() { glGenVertexArrays(1, &id_); }
 
-VertexArray::~VertexArray() { glDeleteVertexArrays(1, &id_); }
+VertexArray::~VertexArray() {
+  RenderState::OnDeleteVertexArray(id_);
+  glDeleteVertexArrays(1, &id_);
+}
 
-void VertexArray::Bind() { glBindVertexArray(id_); }
+void VertexArray::Bind() { RenderState::BindVertexArray(id_); }
 
-void VertexArray::Unbind() { glBindVertexArray(0); }
+void VertexArray::Unbind() { RenderState::BindVertexArray(0); }
 
 void VertexArray::SetVertexBuffer(std::shared_ptr<VertexBuffer> vb) {
-  vertex_buffer_ = vb;
+  vertex_buffers_.clear();
+  attribute_index_ = 0;
+  AddVertexBuffer(vb);
+}
+
+void VertexArray::AddVertexBuffer(std::shared_ptr<VertexBuffer> vb) {
+  vertex_buffers_.push_back(vb);
   Bind();
-  vertex_buffer_->Bind();
-  vertex_buffer_->SetLayout();
+  vb->Bind();
+  attribute_index_ = vb->SetLayout(attribute_index_);
 }
 
 void VertexArray::SetIndexBuffer(std::shared_ptr<IndexBuffer> ib) {
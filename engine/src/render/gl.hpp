@@ -11,8 +11,10 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace MEngine {
@@ -21,30 +23,166 @@ namespace GL {
 
 enum class ShaderDataType { Float, Float2, Float3, Float4, Mat3, Mat4, Int, Int2, Int3, Int4, Bool };
 
+/**
+ * @brief Size in bytes of one attribute of the given type.
+ *
+ */
+unsigned int ShaderDataTypeSize(ShaderDataType type);
+
+/**
+ * @brief Number of scalar components of the given type, a matrix counts all of its columns.
+ *
+ */
+unsigned int ShaderDataTypeComponentCount(ShaderDataType type);
+
 struct ElementLayout {
   ShaderDataType type;
   std::string    name;
 
-  ElementLayout(ShaderDataType type, const std::string &name) : type(type), name(name) {}
+  /**
+   * @brief 0 advances the attribute per vertex, N advances it once every N instances.
+   *
+   */
+  unsigned int divisor;
+
+  ElementLayout(ShaderDataType type, const std::string &name, unsigned int divisor = 0)
+      : type(type), name(name), divisor(divisor) {}
 };
 
 class VertexBuffer {
  public:
   VertexBuffer();
-  ~VertexBuffer();
+  /**
+   * @brief Construct a dynamic vertex buffer with `size` bytes of uninitialized storage.
+   *
+   */
+  VertexBuffer(size_t size);
+  virtual ~VertexBuffer();
   void Bind() const;
   void Unbind() const;
   void SetData(const void *data, size_t size);
+  void SetSubData(const void *data, size_t size, size_t offset = 0);
 
   void AddLayout(const std::vector<ElementLayout> &layouts);
 
-  void SetLayout();
+  /**
+   * @brief Describe the buffer to the currently bound vertex array.
+   *
+   * @param first_index Attribute location of the first element.
+   * @return unsigned int The first attribute location after this buffer. Matrices use one location per column.
+   */
+  unsigned int SetLayout(unsigned int first_index = 0);
 
- private:
+  unsigned int GetStride() const;
+
+ protected:
   unsigned int               id_;
   std::vector<ElementLayout> layouts_;
 };
 
+/**
+ * @brief Ring allocator over a persistently and coherently mapped vertex buffer.
+ *
+ * The storage is split into `region_count` regions. A region is fenced when the
+ * allocator leaves it, either at EndFrame() or because it ran out of space, and
+ * the allocator waits on that fence before writing into the region again. Writes
+ * go straight to the mapped pointer, there is no glBufferData/glMapBuffer per frame.
+ *
+ * @warning the storage is immutable, SetData()/SetSubData() must not be used on it.
+ */
+class StreamBuffer : public VertexBuffer {
+ public:
+  struct Allocation {
+    /**
+     * @brief Mapped pointer to write to, nullptr if the request is larger than a region.
+     *
+     */
+    void *data;
+
+    /**
+     * @brief Byte offset of `data` from the start of the buffer.
+     *
+     */
+    size_t offset;
+  };
+
+  StreamBuffer(size_t region_size, unsigned int region_count = 3);
+  ~StreamBuffer();
+
+  /**
+   * @brief Reserve `size` bytes whose offset is a multiple of `alignment` without consuming
+   * them. Moves to the next region when the current one can not hold them.
+   *
+   */
+  Allocation Reserve(size_t size, size_t alignment = 1);
+
+  /**
+   * @brief Consume `size` bytes from the last Reserve().
+   *
+   */
+  void Commit(size_t size);
+
+  Allocation Allocate(size_t size, size_t alignment = 1);
+
+  /**
+   * @brief Fence the region written this frame and continue in the next one.
+   *
+   */
+  void EndFrame();
+
+  size_t GetRegionSize() const { return region_size_; }
+
+  /**
+   * @brief Number of times the CPU had to wait for the GPU to release a region.
+   *
+   */
+  uint32_t GetStallCount() const { return stall_count_; }
+
+ private:
+  void next_region();
+
+  unsigned char *mapped_;
+
+  size_t       region_size_;
+  unsigned int region_count_;
+  unsigned int region_;
+  size_t       head_;
+  size_t       reserved_;
+
+  // GLsync handles, kept opaque so this header does not need glad.
+  std::vector<void *> fences_;
+
+  uint32_t stall_count_ = 0;
+};
+
+/**
+ * @brief Buffer backing a std140 uniform block, attached to a fixed binding point.
+ *
+ */
+class UniformBuffer {
+ public:
+  UniformBuffer(size_t size, unsigned int binding);
+  ~UniformBuffer();
+
+  void SetData(const void *data, size_t size, size_t offset = 0);
+
+  /**
+   * @brief Upload a whole block. `T` has to mirror the std140 layout of the GLSL block.
+   *
+   */
+  template <typename T>
+  void Upload(const T &block) {
+    static_assert(std::is_trivially_copyable_v<T>, "uniform blocks are copied byte by byte");
+    SetData(&block, sizeof(T));
+  }
+
+  unsigned int GetBinding() const { return binding_; }
+
+ private:
+  unsigned int id_;
+  unsigned int binding_;
+};
+
 class IndexBuffer {
  public:
   IndexBuffer();
@@ -66,15 +204,23 @@ class VertexArray {
   void Bind();
   void Unbind();
   void SetVertexBuffer(std::shared_ptr<VertexBuffer> vb);
+
+  /**
+   * @brief Attach another vertex buffer whose attributes follow the ones already added,
+   * e.g. a per-instance buffer next to the per-vertex one.
+   *
+   */
+  void AddVertexBuffer(std::shared_ptr<VertexBuffer> vb);
   void SetIndexBuffer(std::shared_ptr<IndexBuffer> ib);
 
   int GetCount() const { return index_buffer_->GetCount(); }
 
  private:
   unsigned int id_;
+  unsigned int attribute_index_ = 0;
 
-  std::shared_ptr<VertexBuffer> vertex_buffer_;
-  std::shared_ptr<IndexBuffer>  index_buffer_;
+  std::vector<std::shared_ptr<VertexBuffer>> vertex_buffers_;
+  std::shared_ptr<IndexBuffer>               index_buffer_;
 };
 
 }  // namespace GL
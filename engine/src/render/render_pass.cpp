@@ -1,22 +1,26 @@
 #include "render/render_pass.hpp"
 
 #include "render/render_pipeline.hpp"
+#include "render/render_state.hpp"
 
 namespace MEngine {
 
 RenderPass::RenderPass() { glGenFramebuffers(1, &fb_); }
 
-RenderPass::~RenderPass() { glDeleteFramebuffers(1, &fb_); }
+RenderPass::~RenderPass() {
+  RenderState::OnDeleteFramebuffer(fb_);
+  glDeleteFramebuffers(1, &fb_);
+}
 
 void RenderPass::AddPipeline(std::shared_ptr<RenderPipeline> pipeline) { pipelines_.push_back(pipeline); }
 
 void RenderPass::Begin() {
-  glBindFramebuffer(GL_FRAMEBUFFER, fb_);
+  RenderState::BindFramebuffer(fb_);
   glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
   glClear(GL_COLOR_BUFFER_BIT);
 }
 
-void RenderPass::End() { glBindFramebuffer(GL_FRAMEBUFFER, 0); }
+void RenderPass::End() { RenderState::BindFramebuffer(0); }
 
 void RenderPass::Execute() {
   for (auto &pipeline : pipelines_) {
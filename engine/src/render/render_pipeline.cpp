@@ -17,12 +17,21 @@ void RenderPipeline::SetVertexArray(std::shared_ptr<GL::VertexArray> vao) { vao_
 
 void RenderPipeline::SetShader(std::shared_ptr<Shader> shader) { shader_ = shader; }
 
-void RenderPipeline::Execute() {
+void RenderPipeline::Execute() { Execute(vao_->GetCount()); }
+
+// Program and vertex array stay bound after the draw, RenderState elides the
+// rebinds when the next draw uses the same pipeline.
+void RenderPipeline::Execute(int index_count, int base_vertex) {
+  shader_->Bind();
+  vao_->Bind();
+  glDrawElementsBaseVertex(GL_TRIANGLES, index_count, GL_UNSIGNED_INT, nullptr, base_vertex);
+}
+
+void RenderPipeline::ExecuteInstanced(int instance_count, unsigned int base_instance) {
   shader_->Bind();
   vao_->Bind();
-  glDrawElements(GL_TRIANGLES, vao_->GetCount(), GL_UNSIGNED_INT, nullptr);
-  vao_->Unbind();
-  shader_->Unbind();
+  glDrawElementsInstancedBaseInstance(GL_TRIANGLES, vao_->GetCount(), GL_UNSIGNED_INT, nullptr, instance_count,
+                                      base_instance);
 }
 
 }  // namespace MEngine
\ No newline at end of file
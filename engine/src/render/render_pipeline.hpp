@@ -36,6 +36,20 @@ class RenderPipeline {
 
   void Execute();
 
+  /**
+   * @brief Draw only the first `index_count` indices of the vertex array.
+   *
+   * @param base_vertex Added to every index, used to draw from the middle of a stream buffer.
+   */
+  void Execute(int index_count, int base_vertex = 0);
+
+  /**
+   * @brief Draw the whole vertex array `instance_count` times.
+   *
+   * @param base_instance First element read from the per-instance buffers.
+   */
+  void ExecuteInstanced(int instance_count, unsigned int base_instance = 0);
+
  private:
   std::shared_ptr<GL::VertexArray> vao_;
   std::shared_ptr<Shader>          shader_;
@@ -0,0 +1,83 @@
+#include "render/render_queue.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace MEngine {
+
+static constexpr int kDepthBits    = 23;
+static constexpr int kSequenceBits = 32;
+
+static constexpr uint64_t kSequenceMask = (1ull << kSequenceBits) - 1;
+
+static constexpr int kDepthShift       = kSequenceBits;
+static constexpr int kTranslucentShift = kDepthShift + kDepthBits;
+static constexpr int kLayerShift       = kTranslucentShift + 1;
+
+uint64_t RenderQueue::MakeSortKey(int layer, bool translucent, float depth) {
+  constexpr uint32_t depth_max = (1u << kDepthBits) - 1;
+
+  uint64_t layer_bits = static_cast<uint64_t>(std::clamp(layer, -128, 127) + 128);
+
+  float    normalized = std::clamp((depth + 1.0f) * 0.5f, 0.0f, 1.0f);
+  uint32_t depth_bits = static_cast<uint32_t>(std::lround(normalized * depth_max));
+  // Opaque: closest (largest z) first. Translucent: farthest first.
+  if (!translucent) depth_bits = depth_max - depth_bits;
+
+  return layer_bits << kLayerShift | static_cast<uint64_t>(translucent) << kTranslucentShift |
+         static_cast<uint64_t>(depth_bits) << kDepthShift;
+}
+
+void RenderQueue::Clear() {
+  commands_.clear();
+  keys_.clear();
+  order_.clear();
+}
+
+void RenderQueue::Push(const RenderCommand &command) {
+  uint32_t sequence = static_cast<uint32_t>(commands_.size());
+  order_.push_back(sequence);
+  keys_.push_back((command.sort_key & ~kSequenceMask) | sequence);
+  commands_.push_back(command);
+}
+
+bool RenderQueue::IsTranslucent(size_t i) const { return (keys_[i] >> kTranslucentShift) & 1; }
+
+void RenderQueue::Sort() {
+  const size_t count = keys_.size();
+  if (count < 2) return;
+
+  keys_scratch_.resize(count);
+  order_scratch_.resize(count);
+
+  // The keys are pushed in sequence order and every pass is stable, so the sequence bytes are already sorted.
+  for (int pass = kSequenceBits / 8; pass < 8; pass++) {
+    const int shift = pass * 8;
+
+    size_t histogram[256] = {};
+    for (size_t i = 0; i < count; i++) {
+      histogram[(keys_[i] >> shift) & 0xff]++;
+    }
+
+    // Every key has the same byte here, the pass would not move anything.
+    if (histogram[(keys_[0] >> shift) & 0xff] == count) continue;
+
+    size_t offset = 0;
+    for (size_t &bucket : histogram) {
+      size_t bucket_count = bucket;
+      bucket              = offset;
+      offset += bucket_count;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      size_t destination          = histogram[(keys_[i] >> shift) & 0xff]++;
+      keys_scratch_[destination]  = keys_[i];
+      order_scratch_[destination] = order_[i];
+    }
+
+    keys_.swap(keys_scratch_);
+    order_.swap(order_scratch_);
+  }
+}
+
+}  // namespace MEngine
@@ -0,0 +1,93 @@
+/**
+ * @file render_queue.hpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2024-08-05
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/command.hpp"
+
+namespace MEngine {
+
+/**
+ * @brief Collects the RenderCommands of a frame and orders them by sort key.
+ *
+ * Key layout, from the most significant bit:
+ *
+ * | layer (8) | translucent (1) | depth (23) | sequence (32) |
+ *
+ * Within a layer, opaque quads come first and are ordered front to back so the
+ * depth test rejects hidden fragments early. Translucent quads follow back to
+ * front so blending composes correctly. The sequence is the submission index,
+ * filled in by Push(), so quads at the same depth keep the order they were
+ * submitted in.
+ *
+ * The Renderer draws with GL_LEQUAL and without depth writes for translucent
+ * quads, so at the same depth a later quad covers an earlier one: a higher
+ * layer ends up on top of a lower one. Between opaque quads at different
+ * depths the depth test still decides, whatever their layers.
+ *
+ */
+class RenderQueue {
+ public:
+  RenderQueue()  = default;
+  ~RenderQueue() = default;
+
+  /**
+   * @brief Build a sort key.
+   *
+   * @param layer Clamped to [-128, 127], lower layers draw first and higher ones cover them at equal depth.
+   * @param depth Camera space z in [-1, 1], larger values are closer to the camera.
+   */
+  static uint64_t MakeSortKey(int layer, bool translucent, float depth);
+
+  void Clear();
+
+  /**
+   * @brief Queue `command`, the sequence bits of its key are replaced by the submission index.
+   *
+   */
+  void Push(const RenderCommand &command);
+
+  /**
+   * @brief LSD radix sort of the keys above the sequence, byte positions shared by every key are skipped.
+   *
+   */
+  void Sort();
+
+  size_t Size() const { return commands_.size(); }
+
+  bool Empty() const { return commands_.empty(); }
+
+  /**
+   * @brief The i-th command in sorted order.
+   *
+   */
+  const RenderCommand &operator[](size_t i) const { return commands_[order_[i]]; }
+
+  /**
+   * @brief Whether the i-th command in sorted order was keyed as translucent.
+   *
+   */
+  bool IsTranslucent(size_t i) const;
+
+ private:
+  std::vector<RenderCommand> commands_;
+
+  std::vector<uint64_t> keys_;
+  std::vector<uint32_t> order_;
+
+  std::vector<uint64_t> keys_scratch_;
+  std::vector<uint32_t> order_scratch_;
+};
+
+}  // namespace MEngine
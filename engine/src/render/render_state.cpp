@@ -0,0 +1,192 @@
+#include "render/render_state.hpp"
+
+#include <glad/glad.h>
+
+#include <array>
+
+namespace MEngine {
+
+static constexpr unsigned int kUnknown         = ~0u;
+static constexpr unsigned int kMaxTextureUnits = 32;
+
+enum class BufferTarget { Array, ElementArray, Uniform, Count };
+
+struct CachedState {
+  unsigned int program        = kUnknown;
+  unsigned int vertex_array   = kUnknown;
+  unsigned int framebuffer    = kUnknown;
+  unsigned int active_texture = kUnknown;
+  int          blend          = -1;
+  int          depth_test     = -1;
+  int          depth_write    = -1;
+  unsigned int depth_func     = kUnknown;
+  unsigned int blend_src      = kUnknown;
+  unsigned int blend_dst      = kUnknown;
+
+  std::array<unsigned int, static_cast<size_t>(BufferTarget::Count)> buffers;
+  std::array<unsigned int, kMaxTextureUnits>                          textures;
+
+  CachedState() {
+    buffers.fill(kUnknown);
+    textures.fill(kUnknown);
+  }
+};
+
+static CachedState             s_state;
+static RenderState::Statistics s_current_stats;
+static RenderState::Statistics s_frame_stats;
+
+static bool changed(unsigned int &cached, unsigned int value) {
+  if (cached == value) {
+    s_current_stats.elided++;
+    return false;
+  }
+  cached = value;
+  s_current_stats.issued++;
+  return true;
+}
+
+static bool changed(int &cached, bool value) {
+  if (cached == static_cast<int>(value)) {
+    s_current_stats.elided++;
+    return false;
+  }
+  cached = static_cast<int>(value);
+  s_current_stats.issued++;
+  return true;
+}
+
+static unsigned int *cached_buffer(unsigned int target) {
+  switch (target) {
+    case GL_ARRAY_BUFFER:
+      return &s_state.buffers[static_cast<size_t>(BufferTarget::Array)];
+    case GL_ELEMENT_ARRAY_BUFFER:
+      return &s_state.buffers[static_cast<size_t>(BufferTarget::ElementArray)];
+    case GL_UNIFORM_BUFFER:
+      return &s_state.buffers[static_cast<size_t>(BufferTarget::Uniform)];
+    default:
+      return nullptr;
+  }
+}
+
+void RenderState::UseProgram(unsigned int program) {
+  if (changed(s_state.program, program)) glUseProgram(program);
+}
+
+void RenderState::BindVertexArray(unsigned int vertex_array) {
+  if (changed(s_state.vertex_array, vertex_array)) {
+    glBindVertexArray(vertex_array);
+    // The element array binding belongs to the vertex array.
+    s_state.buffers[static_cast<size_t>(BufferTarget::ElementArray)] = kUnknown;
+  }
+}
+
+void RenderState::BindBuffer(unsigned int target, unsigned int buffer) {
+  unsigned int *cached = cached_buffer(target);
+  if (!cached) {
+    s_current_stats.issued++;
+    glBindBuffer(target, buffer);
+    return;
+  }
+  if (changed(*cached, buffer)) glBindBuffer(target, buffer);
+}
+
+void RenderState::BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer) {
+  s_current_stats.issued++;
+  glBindBufferBase(target, index, buffer);
+  if (unsigned int *cached = cached_buffer(target)) *cached = buffer;
+}
+
+void RenderState::BindTexture(unsigned int unit, unsigned int texture) {
+  if (unit >= kMaxTextureUnits) {
+    s_current_stats.issued += 2;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    s_state.active_texture = unit;
+    return;
+  }
+  if (s_state.textures[unit] == texture) {
+    s_current_stats.elided++;
+    return;
+  }
+  if (changed(s_state.active_texture, unit)) glActiveTexture(GL_TEXTURE0 + unit);
+  if (changed(s_state.textures[unit], texture)) glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void RenderState::BindFramebuffer(unsigned int framebuffer) {
+  if (changed(s_state.framebuffer, framebuffer)) glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+void RenderState::SetBlend(bool enabled) {
+  if (changed(s_state.blend, enabled)) {
+    if (enabled) {
+      glEnable(GL_BLEND);
+    } else {
+      glDisable(GL_BLEND);
+    }
+  }
+}
+
+void RenderState::SetBlendFunc(unsigned int src, unsigned int dst) {
+  if (s_state.blend_src == src && s_state.blend_dst == dst) {
+    s_current_stats.elided++;
+    return;
+  }
+  s_state.blend_src = src;
+  s_state.blend_dst = dst;
+  s_current_stats.issued++;
+  glBlendFunc(src, dst);
+}
+
+void RenderState::SetDepthTest(bool enabled) {
+  if (changed(s_state.depth_test, enabled)) {
+    if (enabled) {
+      glEnable(GL_DEPTH_TEST);
+    } else {
+      glDisable(GL_DEPTH_TEST);
+    }
+  }
+}
+
+void RenderState::SetDepthFunc(unsigned int func) {
+  if (changed(s_state.depth_func, func)) glDepthFunc(func);
+}
+
+void RenderState::SetDepthWrite(bool enabled) {
+  if (changed(s_state.depth_write, enabled)) glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void RenderState::OnDeleteProgram(unsigned int program) {
+  if (s_state.program == program) s_state.program = kUnknown;
+}
+
+void RenderState::OnDeleteVertexArray(unsigned int vertex_array) {
+  if (s_state.vertex_array == vertex_array) s_state.vertex_array = kUnknown;
+}
+
+void RenderState::OnDeleteBuffer(unsigned int buffer) {
+  for (auto &cached : s_state.buffers) {
+    if (cached == buffer) cached = kUnknown;
+  }
+}
+
+void RenderState::OnDeleteTexture(unsigned int texture) {
+  for (auto &cached : s_state.textures) {
+    if (cached == texture) cached = kUnknown;
+  }
+}
+
+void RenderState::OnDeleteFramebuffer(unsigned int framebuffer) {
+  if (s_state.framebuffer == framebuffer) s_state.framebuffer = kUnknown;
+}
+
+void RenderState::Invalidate() { s_state = CachedState(); }
+
+void RenderState::BeginFrame() {
+  s_frame_stats   = s_current_stats;
+  s_current_stats = Statistics();
+}
+
+const RenderState::Statistics &RenderState::GetFrameStats() { return s_frame_stats; }
+
+}  // namespace MEngine
@@ -0,0 +1,101 @@
+/**
+ * @file render_state.hpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2024-08-02
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace MEngine {
+
+/**
+ * @brief Shadow copy of the GL binding and fixed-function state of the current context.
+ *
+ * Every bind in the engine goes through here so calls that would not change
+ * anything are skipped. Code that touches GL behind its back (e.g. ImGui) must
+ * call Invalidate() afterwards.
+ *
+ */
+class RenderState {
+ public:
+  struct Statistics {
+    uint32_t issued = 0;
+    uint32_t elided = 0;
+  };
+
+  static void UseProgram(unsigned int program);
+
+  static void BindVertexArray(unsigned int vertex_array);
+
+  /**
+   * @brief Bind `buffer` to a generic binding point such as GL_ARRAY_BUFFER.
+   *
+   */
+  static void BindBuffer(unsigned int target, unsigned int buffer);
+
+  /**
+   * @brief glBindBufferBase, which also replaces the generic binding of `target`.
+   *
+   */
+  static void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer);
+
+  /**
+   * @brief Bind a GL_TEXTURE_2D to texture unit `unit`.
+   *
+   */
+  static void BindTexture(unsigned int unit, unsigned int texture);
+
+  static void BindFramebuffer(unsigned int framebuffer);
+
+  static void SetBlend(bool enabled);
+
+  static void SetBlendFunc(unsigned int src, unsigned int dst);
+
+  static void SetDepthTest(bool enabled);
+
+  /**
+   * @brief glDepthFunc, e.g. GL_LEQUAL.
+   *
+   */
+  static void SetDepthFunc(unsigned int func);
+
+  /**
+   * @brief glDepthMask. glClear() honours it too, leave depth writes on outside of a draw.
+   *
+   */
+  static void SetDepthWrite(bool enabled);
+
+  // GL silently resets bindings of deleted objects, and a new object may get the same name.
+  static void OnDeleteProgram(unsigned int program);
+  static void OnDeleteVertexArray(unsigned int vertex_array);
+  static void OnDeleteBuffer(unsigned int buffer);
+  static void OnDeleteTexture(unsigned int texture);
+  static void OnDeleteFramebuffer(unsigned int framebuffer);
+
+  /**
+   * @brief Forget everything, the next call of each kind is always issued.
+   *
+   */
+  static void Invalidate();
+
+  /**
+   * @brief Close the statistics of the previous frame and start counting a new one.
+   *
+   */
+  static void BeginFrame();
+
+  /**
+   * @brief Calls issued and elided during the last complete frame.
+   *
+   */
+  static const Statistics &GetFrameStats();
+};
+
+}  // namespace MEngine
@@ -2,117 +2,408 @@
 
 #include <glad/glad.h>
 
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "core/asset_manager.hpp"
 #include "core/command.hpp"
+#include "core/job_system.hpp"
 #include "render/gl.hpp"
 #include "render/render_pass.hpp"
 #include "render/render_pipeline.hpp"
+#include "render/render_state.hpp"
 #include "render/shader.hpp"
+#include "render/texture.hpp"
 #include "scene/component.hpp"
 
 namespace MEngine {
 
+static const glm::vec4 s_quad_positions[4] = {
+    {-0.5f, -0.5f, 0.0f, 1.0f},  // bottom left
+    {0.5f, -0.5f, 0.0f, 1.0f},   // bottom right
+    {0.5f, 0.5f, 0.0f, 1.0f},    // top right
+    {-0.5f, 0.5f, 0.0f, 1.0f},   // top left
+};
+
 Renderer::Renderer() {
   logger_ = Logger::Get("Renderer");
 
-  float vertices[] = {
+  // Each region holds two full batches, so 20k sprites per frame use about one region.
+  quad_vertex_buffer_ = std::make_shared<GL::StreamBuffer>(2 * kMaxVertices * sizeof(QuadVertex));
+  quad_vertex_buffer_->AddLayout({
+      {GL::ShaderDataType::Float3, "aPos"},
+      {GL::ShaderDataType::Float4, "aColor"},
+      {GL::ShaderDataType::Float2, "aTexCoord"},
+      {GL::ShaderDataType::Float, "aTexIndex"},
+  });
+
+  // Every quad uses the same index pattern, so the index buffer is filled once.
+  std::vector<unsigned int> indices(kMaxIndices);
+  for (uint32_t i = 0, offset = 0; i < kMaxIndices; i += 6, offset += 4) {
+    indices[i + 0] = offset + 0;
+    indices[i + 1] = offset + 1;
+    indices[i + 2] = offset + 2;
+    indices[i + 3] = offset + 2;
+    indices[i + 4] = offset + 3;
+    indices[i + 5] = offset + 0;
+  }
+
+  auto index_buffer = std::make_shared<GL::IndexBuffer>();
+  index_buffer->SetData(indices.data(), kMaxIndices);
+
+  auto vertex_array = std::make_shared<GL::VertexArray>();
+  vertex_array->SetVertexBuffer(quad_vertex_buffer_);
+  vertex_array->SetIndexBuffer(index_buffer);
+  // Unbind so later buffer uploads can not touch the element binding of this VAO.
+  vertex_array->Unbind();
+
+  GLint texture_units = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &texture_units);
+  max_texture_slots_ = std::min<uint32_t>(std::max(texture_units, 1), kMaxTextureSlots);
+  logger_->info("Batching up to {} textures per draw call", max_texture_slots_);
+
+  texture_slots_.reserve(max_texture_slots_);
+
+  ShaderDefines    defines{{"MAX_TEXTURE_SLOTS", std::to_string(max_texture_slots_)}};
+  std::vector<int> samplers(max_texture_slots_);
+  for (uint32_t i = 0; i < max_texture_slots_; i++) {
+    samplers[i] = static_cast<int>(i);
+  }
+
+  camera_uniform_buffer_ = std::make_shared<GL::UniformBuffer>(sizeof(CameraData), kCameraBinding);
+
+  // TODO: 默认 shader 怎么存放
+  auto shader = std::make_shared<Shader>("res/shaders/default_vert.glsl", "res/shaders/default_frag.glsl", defines);
+  shader->SetUniformArray("textures", samplers.data(), static_cast<int>(samplers.size()));
+
+  pipeline_ = std::make_shared<RenderPipeline>();
+
+  pipeline_->SetVertexArray(vertex_array);
+  pipeline_->SetShader(shader);
+
+  // Instanced path: a unit quad shared by all sprites plus one SpriteInstance per sprite.
+  float quad_vertices[] = {
       // positions        // texture coords
       0.5f,  0.5f,  0.0f, 1.0f, 1.0f,  // top right
       0.5f,  -0.5f, 0.0f, 1.0f, 0.0f,  // bottom right
       -0.5f, -0.5f, 0.0f, 0.0f, 0.0f,  // bottom left
       -0.5f, 0.5f,  0.0f, 0.0f, 1.0f   // top left
   };
-  unsigned int indices[] = {
+  unsigned int quad_indices[] = {
       0, 1, 3,  // first triangle
       1, 2, 3   // second triangle
   };
 
-  auto vertex_buffer = std::make_shared<GL::VertexBuffer>();
-  vertex_buffer->SetData(vertices, sizeof(vertices));
-  vertex_buffer->AddLayout({
+  auto unit_quad_buffer = std::make_shared<GL::VertexBuffer>();
+  unit_quad_buffer->SetData(quad_vertices, sizeof(quad_vertices));
+  unit_quad_buffer->AddLayout({
       {GL::ShaderDataType::Float3, "aPos"},
       {GL::ShaderDataType::Float2, "aTexCoord"},
   });
 
-  auto index_buffer = std::make_shared<GL::IndexBuffer>();
-  index_buffer->SetData(indices, 6);
+  auto unit_quad_indices = std::make_shared<GL::IndexBuffer>();
+  unit_quad_indices->SetData(quad_indices, 6);
 
-  auto vertex_array = std::make_shared<GL::VertexArray>();
-  vertex_array->SetVertexBuffer(vertex_buffer);
-  vertex_array->SetIndexBuffer(index_buffer);
+  instance_buffer_ = std::make_shared<GL::StreamBuffer>(2 * kMaxQuads * sizeof(SpriteInstance));
+  instance_buffer_->AddLayout({
+      {GL::ShaderDataType::Float2, "iAxisX", 1},
+      {GL::ShaderDataType::Float2, "iAxisY", 1},
+      {GL::ShaderDataType::Float3, "iPosition", 1},
+      {GL::ShaderDataType::Float4, "iColor", 1},
+      {GL::ShaderDataType::Float4, "iUVRect", 1},
+      {GL::ShaderDataType::Float, "iTexIndex", 1},
+  });
 
-  // TODO: 默认 shader 怎么存放
-  auto shader = std::make_shared<Shader>("res/shaders/default_vert.glsl", "res/shaders/default_frag.glsl");
-  shader->Bind();
-  shader->SetUniform("texture1", 0);
-  shader->Unbind();
+  auto instanced_array = std::make_shared<GL::VertexArray>();
+  instanced_array->SetVertexBuffer(unit_quad_buffer);
+  instanced_array->AddVertexBuffer(instance_buffer_);
+  instanced_array->SetIndexBuffer(unit_quad_indices);
+  instanced_array->Unbind();
 
-  pipeline_ = std::make_shared<RenderPipeline>();
+  auto instanced_shader =
+      std::make_shared<Shader>("res/shaders/instanced_vert.glsl", "res/shaders/default_frag.glsl", defines);
+  instanced_shader->SetUniformArray("textures", samplers.data(), static_cast<int>(samplers.size()));
 
-  pipeline_->SetVertexArray(vertex_array);
-  pipeline_->SetShader(shader);
+  instanced_pipeline_ = std::make_shared<RenderPipeline>();
+  instanced_pipeline_->SetVertexArray(instanced_array);
+  instanced_pipeline_->SetShader(instanced_shader);
 
   pass_ = std::make_shared<RenderPass>();
   pass_->AddPipeline(pipeline_);
+  pass_->AddPipeline(instanced_pipeline_);
+
+  // Untextured sprites sample a single white texel so they can share the textured path.
+  static unsigned char white[4] = {255, 255, 255, 255};
+  white_texture_                = std::make_shared<Texture>();
+  white_texture_->SetData(white, 1, 1);
 }
 
 Renderer::~Renderer() {}
 
-void Renderer::RenderSprite(Sprite2D &sprite, const glm::mat4 &proj_view) {
-  static std::shared_ptr<Texture> plain_texture = std::make_shared<Texture>();
-  if (!sprite.texture) {
-    // 根据 sprite 颜色绘制纯色texture
+void Renderer::BeginFrame() { stats_ = Statistics(); }
+
+void Renderer::EndFrame() {
+  quad_vertex_buffer_->EndFrame();
+  instance_buffer_->EndFrame();
+  stats_.stream_stalls = quad_vertex_buffer_->GetStallCount() + instance_buffer_->GetStallCount();
+}
+
+void Renderer::BeginBatch(const glm::mat4 &proj_view) {
+  // Uploaded once here, every draw of the batch reads it from the Camera block.
+  CameraData camera;
+  camera.proj_view = proj_view;
+  camera_uniform_buffer_->Upload(camera);
+  proj_view_ = proj_view;
+  texture_slots_.clear();
+  queue_.Clear();
+
+  // Quads later in the sort order (a higher layer, or submitted later) win ties in depth.
+  RenderState::SetDepthFunc(GL_LEQUAL);
+  RenderState::SetDepthWrite(true);
+}
+
+int Renderer::acquire_texture_slot(TextureHandle texture) {
+  for (size_t i = 0; i < texture_slots_.size(); i++) {
+    if (texture_slots_[i] == texture) return static_cast<int>(i);
+  }
+  if (texture_slots_.size() >= max_texture_slots_) return -1;
+  texture_slots_.push_back(texture);
+  return static_cast<int>(texture_slots_.size() - 1);
+}
+
+bool Renderer::IsTranslucent(const glm::vec4 &color, TextureHandle texture) {
+  const Texture *resolved = AssetManager::Get().ResolveTexture(texture);
+  return color.a < 1.0f || (resolved && resolved->HasAlpha());
+}
+
+uint64_t Renderer::make_sort_key(const glm::mat4 &model, const glm::vec4 &color, TextureHandle texture,
+                                 int layer) const {
+  bool translucent = IsTranslucent(color, texture);
 
-    // 生成纯色纹理
-    unsigned char color[4] = {static_cast<unsigned char>(sprite.color[0]), static_cast<unsigned char>(sprite.color[1]),
-                              static_cast<unsigned char>(sprite.color[2]), static_cast<unsigned char>(sprite.color[3])};
-    plain_texture->SetData(color, 1, 1);
+  // Normalized device z grows away from the camera, the key wants larger values closer.
+  glm::vec4 clip  = proj_view_ * model[3];
+  float     depth = clip.w != 0.0f ? -clip.z / clip.w : 0.0f;
+  return RenderQueue::MakeSortKey(layer, translucent, depth);
+}
+
+void Renderer::Submit(const glm::mat4 &model, const glm::vec4 &color, TextureHandle texture, const glm::vec4 &uv_rect,
+                      int layer) {
+  RenderCommand command;
+  command.model_matrix = model;
+  command.color        = color;
+  command.texture      = texture;
+  command.uv_rect      = uv_rect;
+  command.sort_key     = make_sort_key(model, color, texture, layer);
+  queue_.Push(command);
+}
+
+void Renderer::Submit(const RenderCommand &command) { queue_.Push(command); }
+
+void Renderer::Submit(const glm::mat4 &model, const Sprite2D &sprite, const glm::vec4 &uv_rect) {
+  Submit(model, sprite.color, sprite.texture, uv_rect, sprite.layer);
+}
 
-    auto shader = pipeline_->GetShader();
+void Renderer::SubmitBatch(const SpriteStreams &sprites, TextureHandle texture) {
+  Flush();
 
-    shader->Bind();
-    plain_texture->Bind();
+  size_t first = 0;
+  while (first < sprites.count) {
+    int slot = acquire_texture_slot(texture);
+    if (slot < 0) {
+      flush_draw();
+      slot = acquire_texture_slot(texture);
+    }
 
-    shader->SetUniform("model", sprite.GetModelMatrix());
-    shader->SetUniform("proj_view", proj_view);
-    shader->SetUniform("texture1", 0);
+    if (render_mode_ == RenderMode::Instanced) {
+      if (!instances_) {
+        auto allocation = instance_buffer_->Reserve(kMaxQuads * sizeof(SpriteInstance), sizeof(SpriteInstance));
+        instances_      = static_cast<SpriteInstance *>(allocation.data);
+        instance_base_  = static_cast<unsigned int>(allocation.offset / sizeof(SpriteInstance));
+      }
 
-    pipeline_->Execute();
-  } else {
-    auto shader  = pipeline_->GetShader();
-    auto texture = sprite.texture;
+      size_t count = std::min<size_t>(sprites.count - first, kMaxQuads - instance_count_);
+      for (size_t i = first; i < first + count; i++) {
+        float c = std::cos(sprites.rotation[i]);
+        float s = std::sin(sprites.rotation[i]);
 
-    shader->Bind();
-    texture->Bind();
+        SpriteInstance &instance = instances_[instance_count_++];
+        instance.axis_x          = glm::vec2(c, s) * sprites.scale_x[i];
+        instance.axis_y          = glm::vec2(-s, c) * sprites.scale_y[i];
+        instance.position        = glm::vec3(sprites.position_x[i], sprites.position_y[i], sprites.position_z[i]);
+        instance.color           = sprites.color[i];
+        instance.uv_rect         = sprites.uv_rect ? sprites.uv_rect[i] : glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+        instance.tex_index       = static_cast<float>(slot);
+      }
+      first += count;
+      stats_.quad_count += static_cast<uint32_t>(count);
 
-    shader->SetUniform("model", sprite.GetModelMatrix());
-    shader->SetUniform("proj_view", proj_view);
-    shader->SetUniform("texture1", 0);
+      if (instance_count_ >= kMaxQuads) flush_draw();
+    } else {
+      if (!quad_vertices_) {
+        auto allocation   = quad_vertex_buffer_->Reserve(kMaxVertices * sizeof(QuadVertex), sizeof(QuadVertex));
+        quad_vertices_    = static_cast<QuadVertex *>(allocation.data);
+        quad_base_vertex_ = static_cast<int>(allocation.offset / sizeof(QuadVertex));
+      }
 
-    pipeline_->Execute();
+      // The kernel writes straight into the mapped buffer, one chunk per remaining batch space,
+      // split into disjoint vertex ranges over the job system.
+      size_t      count  = std::min<size_t>(sprites.count - first, (kMaxVertices - quad_vertex_count_) / 4);
+      QuadVertex *target = quad_vertices_ + quad_vertex_count_;
+      JobSystem::Get().ParallelFor("EmitQuads", count, 4096, [&](size_t begin, size_t end) {
+        SpriteKernel::EmitQuads(sprites.Slice(first + begin, end - begin), static_cast<float>(slot),
+                                target + begin * 4);
+      });
+      quad_vertex_count_ += static_cast<uint32_t>(count * 4);
+      first += count;
+      stats_.quad_count += static_cast<uint32_t>(count);
+
+      if (quad_vertex_count_ >= kMaxVertices) flush_draw();
+    }
   }
+
+  flush_draw();
 }
 
-void Renderer::RenderSprite(AnimatedSprite2D &sprite, const glm::mat4 &proj_view) {
-  auto shader  = pipeline_->GetShader();
-  auto texture = sprite.texture;
+void Renderer::draw_quad(const RenderCommand &command) {
+  TextureHandle quad_texture = command.texture;
 
-  shader->Bind();
-  texture->SetSubTexture(sprite.current_frame);
+  if (quad_vertex_count_ >= kMaxVertices) {
+    flush_draw();
+  }
 
-  shader->SetUniform("model", sprite.GetModelMatrix());
-  shader->SetUniform("proj_view", proj_view);
-  shader->SetUniform("texture1", 0);
+  int slot = acquire_texture_slot(quad_texture);
+  if (slot < 0) {
+    flush_draw();
+    slot = acquire_texture_slot(quad_texture);
+  }
 
-  pipeline_->Execute();
-  // pass_->Begin();
+  if (!quad_vertices_) {
+    // Reserve room for a full batch and write the vertices straight into the mapped buffer.
+    auto allocation   = quad_vertex_buffer_->Reserve(kMaxVertices * sizeof(QuadVertex), sizeof(QuadVertex));
+    quad_vertices_    = static_cast<QuadVertex *>(allocation.data);
+    quad_base_vertex_ = static_cast<int>(allocation.offset / sizeof(QuadVertex));
+  }
 
-  // pass_->Execute();
+  const glm::mat4 &model   = command.model_matrix;
+  const glm::vec4 &color   = command.color;
+  const glm::vec4 &uv_rect = command.uv_rect;
 
-  // pass_->End();
+  const glm::vec2 tex_coords[4] = {
+      {uv_rect.x, uv_rect.y},
+      {uv_rect.z, uv_rect.y},
+      {uv_rect.z, uv_rect.w},
+      {uv_rect.x, uv_rect.w},
+  };
 
-  // texture->Unbind();
+  QuadVertex *vertex = quad_vertices_ + quad_vertex_count_;
+  for (int i = 0; i < 4; i++, vertex++) {
+    vertex->position  = glm::vec3(model * s_quad_positions[i]);
+    vertex->color     = color;
+    vertex->tex_coord = tex_coords[i];
+    vertex->tex_index = static_cast<float>(slot);
+  }
+  quad_vertex_count_ += 4;
+
+  stats_.quad_count++;
 }
 
+void Renderer::draw_instance(const RenderCommand &command) {
+  TextureHandle quad_texture = command.texture;
+
+  if (instance_count_ >= kMaxQuads) {
+    flush_draw();
+  }
+
+  int slot = acquire_texture_slot(quad_texture);
+  if (slot < 0) {
+    flush_draw();
+    slot = acquire_texture_slot(quad_texture);
+  }
+
+  if (!instances_) {
+    auto allocation = instance_buffer_->Reserve(kMaxQuads * sizeof(SpriteInstance), sizeof(SpriteInstance));
+    instances_      = static_cast<SpriteInstance *>(allocation.data);
+    instance_base_  = static_cast<unsigned int>(allocation.offset / sizeof(SpriteInstance));
+  }
+
+  // The basis columns are copied as is, nothing is decomposed.
+  const glm::mat4 &model = command.model_matrix;
+
+  SpriteInstance &instance = instances_[instance_count_++];
+  instance.axis_x          = glm::vec2(model[0]);
+  instance.axis_y          = glm::vec2(model[1]);
+  instance.position        = glm::vec3(model[3]);
+  instance.color           = command.color;
+  instance.uv_rect         = command.uv_rect;
+  instance.tex_index       = static_cast<float>(slot);
+
+  stats_.quad_count++;
+}
+
+void Renderer::bind_texture_slots() {
+  // Untextured quads and stale handles fall back to the white texture, textures still loading to the placeholder.
+  auto &assets = AssetManager::Get();
+  for (size_t i = 0; i < texture_slots_.size(); i++) {
+    const Texture *texture = assets.ResolveTexture(texture_slots_[i]);
+    (texture ? texture : white_texture_.get())->Bind(static_cast<unsigned int>(i));
+  }
+  stats_.texture_binds += static_cast<uint32_t>(texture_slots_.size());
+}
+
+void Renderer::flush_draw() {
+  if (quad_vertex_count_ > 0) {
+    quad_vertex_buffer_->Commit(quad_vertex_count_ * sizeof(QuadVertex));
+
+    bind_texture_slots();
+
+    pipeline_->Execute(static_cast<int>(quad_vertex_count_ / 4 * 6), quad_base_vertex_);
+
+    stats_.draw_calls++;
+  } else if (instance_count_ > 0) {
+    instance_buffer_->Commit(instance_count_ * sizeof(SpriteInstance));
+
+    bind_texture_slots();
+
+    instanced_pipeline_->ExecuteInstanced(static_cast<int>(instance_count_), instance_base_);
+
+    stats_.draw_calls++;
+  }
+
+  quad_vertices_     = nullptr;
+  quad_vertex_count_ = 0;
+  instances_         = nullptr;
+  instance_count_    = 0;
+  texture_slots_.clear();
+}
+
+void Renderer::Flush() {
+  queue_.Sort();
+
+  // Translucent quads are still tested against the opaque ones but write no depth, so whatever
+  // follows them at the same depth (the next layer) is not rejected.
+  bool translucent = false;
+  for (size_t i = 0; i < queue_.Size(); i++) {
+    if (queue_.IsTranslucent(i) != translucent) {
+      flush_draw();
+      translucent = !translucent;
+      RenderState::SetDepthWrite(!translucent);
+    }
+
+    if (render_mode_ == RenderMode::Instanced) {
+      draw_instance(queue_[i]);
+    } else {
+      draw_quad(queue_[i]);
+    }
+  }
+  flush_draw();
+  RenderState::SetDepthWrite(true);
+
+  queue_.Clear();
+}
+
+void Renderer::EndBatch() { Flush(); }
+
 GLuint Renderer::GetFramebuffer() { return pass_->GetFramebuffer(); }
 
-}  // namespace MEngine
\ No newline at end of file
+}  // namespace MEngine
@@ -13,32 +13,244 @@
 
 #include <glad/glad.h>
 
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <memory>
+#include <vector>
 
 #include "core/logger.hpp"
 #include "render/gl.hpp"
+#include "render/render_queue.hpp"
+#include "render/sprite_kernel.hpp"
+#include "render/texture.hpp"
 
 namespace MEngine {
 
 struct Sprite2D;
-struct AnimatedSprite2D;
 class RenderPipeline;
 class RenderPass;
 
+/**
+ * @brief Vertex layout of a batched quad, already transformed into world space.
+ *
+ */
+struct QuadVertex {
+  glm::vec3 position;
+  glm::vec4 color;
+  glm::vec2 tex_coord;
+  float     tex_index;
+};
+
+/**
+ * @brief Per-instance data of the instanced sprite path. The vertex shader places the
+ * corners with the x and y columns of the model matrix, so any 2D affine transform,
+ * mirrored or sheared included, draws the same as on the batched path.
+ *
+ */
+struct SpriteInstance {
+  glm::vec2 axis_x;
+  glm::vec2 axis_y;
+  glm::vec3 position;
+  glm::vec4 color;
+  glm::vec4 uv_rect;
+  float     tex_index;
+};
+
+/**
+ * @brief std140 mirror of the `Camera` uniform block shared by the sprite shaders.
+ *
+ */
+struct CameraData {
+  glm::mat4 proj_view;
+};
+
 class Renderer {
  public:
+  enum class RenderMode {
+    /**
+     * @brief Quads are transformed on the CPU and appended to one vertex buffer.
+     *
+     */
+    Batched,
+    /**
+     * @brief The unit quad is drawn once per sprite from a per-instance buffer.
+     *
+     */
+    Instanced,
+  };
+
+  /**
+   * @brief Counters collected between BeginFrame() and EndFrame().
+   *
+   */
+  struct Statistics {
+    uint32_t draw_calls    = 0;
+    uint32_t quad_count    = 0;
+    uint32_t texture_binds = 0;
+    // Total number of waits on the stream buffer fences since startup.
+    uint32_t stream_stalls = 0;
+
+    float GetQuadsPerBatch() const { return draw_calls == 0 ? 0.0f : (float)quad_count / draw_calls; }
+  };
+
+  static constexpr uint32_t kMaxQuads    = 10000;
+  static constexpr uint32_t kMaxVertices = kMaxQuads * 4;
+  static constexpr uint32_t kMaxIndices  = kMaxQuads * 6;
+
+  /**
+   * @brief Upper bound of the sampler array in the default shader, the real
+   * limit is min(kMaxTextureSlots, GL_MAX_TEXTURE_IMAGE_UNITS).
+   *
+   */
+  static constexpr uint32_t kMaxTextureSlots = 32;
+
+  /**
+   * @brief Uniform buffer binding point of the `Camera` block.
+   *
+   */
+  static constexpr unsigned int kCameraBinding = 0;
+
   Renderer();
   ~Renderer();
 
-  void RenderSprite(Sprite2D &sprite, const glm::mat4 &proj_view);
-  void RenderSprite(AnimatedSprite2D &sprite, const glm::mat4 &proj_view);
+  /**
+   * @brief Reset the statistics, call once per frame before the first batch.
+   *
+   */
+  void BeginFrame();
+
+  /**
+   * @brief Fence the streaming buffers so the next frame writes into fresh regions.
+   *
+   */
+  void EndFrame();
+
+  /**
+   * @brief Start collecting quads for the camera described by `proj_view`.
+   *
+   */
+  void BeginBatch(const glm::mat4 &proj_view);
+
+  /**
+   * @brief Queue one quad, it is drawn when the batch ends.
+   *
+   * @param model World transform of the unit quad.
+   * @param color Tint multiplied with the texture sample.
+   * @param texture Handle of the texture to sample, or AssetManager::kInvalidHandle for a plain colored quad.
+   * @param uv_rect Texture region as (u0, v0, u1, v1).
+   * @param layer Coarse draw order, lower layers draw first and higher ones cover them at equal depth.
+   */
+  void Submit(const glm::mat4 &model, const glm::vec4 &color, TextureHandle texture,
+              const glm::vec4 &uv_rect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), int layer = 0);
+
+  /**
+   * @brief Queue a prepared command, its sort key is used as is.
+   *
+   */
+  void Submit(const RenderCommand &command);
+
+  /**
+   * @brief Queue `sprite` drawn with the world matrix `model`.
+   *
+   */
+  void Submit(const glm::mat4 &model, const Sprite2D &sprite,
+              const glm::vec4 &uv_rect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+
+  /**
+   * @brief Draw many sprites sharing one texture straight from SoA streams,
+   * bypassing the sort queue. Anything queued before is flushed first so the
+   * submission order is kept.
+   *
+   */
+  void SubmitBatch(const SpriteStreams &sprites, TextureHandle texture);
+
+  /**
+   * @brief Whether a quad of this color and texture is blended, and so sorted back to front.
+   *
+   */
+  static bool IsTranslucent(const glm::vec4 &color, TextureHandle texture);
+
+  /**
+   * @brief Sort the queued commands and draw them through the path selected by the RenderMode.
+   *
+   */
+  void Flush();
+
+  /**
+   * @brief Flush everything queued since BeginBatch().
+   *
+   */
+  void EndBatch();
+
+  void SetRenderMode(RenderMode mode) { render_mode_ = mode; }
+
+  RenderMode GetRenderMode() const { return render_mode_; }
+
+  const Statistics &GetStats() const { return stats_; }
 
   GLuint GetFramebuffer();
 
  private:
+  /**
+   * @brief Append one quad to the current draw, flushing first if the draw is
+   * full or every texture slot is taken by another texture.
+   *
+   */
+  void draw_quad(const RenderCommand &command);
+
+  /**
+   * @brief Append one quad to the instanced draw. Only the xy part of the model matrix and
+   * its translation are kept, the quad stays in a plane of constant z.
+   *
+   */
+  void draw_instance(const RenderCommand &command);
+
+  /**
+   * @brief Issue the draw call of whatever draw_quad() or draw_instance() collected.
+   *
+   */
+  void flush_draw();
+
+  void bind_texture_slots();
+
+  uint64_t make_sort_key(const glm::mat4 &model, const glm::vec4 &color, TextureHandle texture, int layer) const;
+
+  RenderQueue queue_;
+
+  // Camera of the current batch, sort keys use the depth of the quads in its clip space.
+  glm::mat4 proj_view_ = glm::mat4(1.0f);
+
   std::shared_ptr<RenderPass>     pass_;
   std::shared_ptr<RenderPipeline> pipeline_;
+  std::shared_ptr<RenderPipeline> instanced_pipeline_;
+
+  RenderMode render_mode_ = RenderMode::Batched;
+
+  std::shared_ptr<GL::StreamBuffer> quad_vertex_buffer_;
+  QuadVertex                       *quad_vertices_     = nullptr;
+  uint32_t                          quad_vertex_count_ = 0;
+  int                               quad_base_vertex_  = 0;
+
+  std::shared_ptr<GL::StreamBuffer> instance_buffer_;
+  SpriteInstance                   *instances_          = nullptr;
+  uint32_t                          instance_count_     = 0;
+  unsigned int                      instance_base_      = 0;
+
+  /**
+   * @brief Find the slot `texture` is bound to in the current batch, or assign it
+   * a free one. Returns -1 when all slots are in use.
+   *
+   */
+  int acquire_texture_slot(TextureHandle texture);
+
+  std::shared_ptr<Texture> white_texture_;
+
+  std::vector<TextureHandle> texture_slots_;
+  uint32_t                   max_texture_slots_;
+
+  std::shared_ptr<GL::UniformBuffer> camera_uniform_buffer_;
+
+  Statistics stats_;
 
   std::shared_ptr<spdlog::logger> logger_;
 };
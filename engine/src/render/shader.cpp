@@ -2,67 +2,18 @@
 
 #include <glad/glad.h>
 
+#include <algorithm>
 #include <fstream>
 
+#include "render/render_state.hpp"
+
 namespace MEngine {
 
-Shader::Shader(const std::string &vert_path, const std::string &frag_path)
+Shader::Shader(const std::string &vert_path, const std::string &frag_path, const ShaderDefines &defines)
     : vert_path_(vert_path), frag_path_(frag_path) {
-  logger_                    = Logger::Get("Shader");
-  std::vector<char> vert_src = read_file(vert_path);
-  std::vector<char> frag_src = read_file(frag_path);
-
-  if (vert_src.empty() || frag_src.empty()) return;
+  logger_ = Logger::Get("Shader");
 
-  const char *vertCode = vert_src.data();
-  const char *fragCode = frag_src.data();
-
-  // 创建顶点着色器
-  unsigned int vert_shader = glCreateShader(GL_VERTEX_SHADER);
-  // 将着色器源码附加到着色器对象
-  glShaderSource(vert_shader, 1, &vertCode, nullptr);
-  glCompileShader(vert_shader);
-  int  success;
-  char infoLog[512];
-  glGetShaderiv(vert_shader, GL_COMPILE_STATUS, &success);
-  if (!success) {
-    glGetShaderInfoLog(vert_shader, 512, nullptr, infoLog);
-    logger_->critical("Failed compilation for vertex shader! detail:\n{}", infoLog);
-    glDeleteShader(vert_shader);
-    return;
-  }
-
-  // 创建片段着色器
-  unsigned int frag_shader = glCreateShader(GL_FRAGMENT_SHADER);
-  glShaderSource(frag_shader, 1, &fragCode, nullptr);
-  glCompileShader(frag_shader);
-  glGetShaderiv(frag_shader, GL_COMPILE_STATUS, &success);
-  if (!success) {
-    glGetShaderInfoLog(frag_shader, 512, nullptr, infoLog);
-    logger_->critical("Failed compilation for fragment shader! detail:\n{}", infoLog);
-    glDeleteShader(vert_shader);
-    glDeleteShader(frag_shader);
-    return;
-  }
-
-  // 创建程序对象
-  unsigned int shader_program = glCreateProgram();
-  // 将之前编译的着色器附加到程序对象上
-  glAttachShader(shader_program, vert_shader);
-  glAttachShader(shader_program, frag_shader);
-  glLinkProgram(shader_program);
-  glGetProgramiv(shader_program, GL_LINK_STATUS, &success);
-  if (!success) {
-    glGetProgramInfoLog(shader_program, 512, nullptr, infoLog);
-    logger_->critical("Failed link for program! detail:\n{}", infoLog);
-    glDeleteShader(vert_shader);
-    glDeleteShader(frag_shader);
-    glDeleteProgram(shader_program);
-    return;
-  }
-  glDeleteShader(vert_shader);
-  glDeleteShader(frag_shader);
-  id_ = shader_program;
+  compile(defines);
 
   auto pos = vert_path.find_last_of("/\\");
   if (pos == std::string::npos) {
@@ -77,16 +28,27 @@ Shader::Shader(const std::string &vert_path, const std::string &frag_path)
   }
 }
 
-Shader::Shader(const std::string &name, const std::string &vert_path, const std::string &frag_path)
+Shader::Shader(const std::string &name, const std::string &vert_path, const std::string &frag_path,
+               const ShaderDefines &defines)
     : name_(name), vert_path_(vert_path), frag_path_(frag_path) {
-  logger_                    = Logger::Get("Shader");
-  std::vector<char> vert_src = read_file(vert_path);
-  std::vector<char> frag_src = read_file(frag_path);
+  logger_ = Logger::Get("Shader");
+
+  compile(defines);
+}
+
+void Shader::compile(const ShaderDefines &defines) {
+  id_ = 0;
+
+  std::vector<char> vert_src = read_file(vert_path_);
+  std::vector<char> frag_src = read_file(frag_path_);
 
   if (vert_src.empty() || frag_src.empty()) return;
 
-  const char *vertCode = vert_src.data();
-  const char *fragCode = frag_src.data();
+  std::string vert_code = inject_defines(vert_src.data(), defines);
+  std::string frag_code = inject_defines(frag_src.data(), defines);
+
+  const char *vertCode = vert_code.c_str();
+  const char *fragCode = frag_code.c_str();
 
   // 创建顶点着色器
   unsigned int vert_shader = glCreateShader(GL_VERTEX_SHADER);
@@ -134,13 +96,111 @@ Shader::Shader(const std::string &name, const std::string &vert_path, const std:
   glDeleteShader(vert_shader);
   glDeleteShader(frag_shader);
   id_ = shader_program;
+
+  reflect_uniforms();
 }
 
-Shader::~Shader() { glDeleteProgram(id_); }
+void Shader::reflect_uniforms() {
+  uniforms_.clear();
+
+  int count      = 0;
+  int max_length = 0;
+  glGetProgramiv(id_, GL_ACTIVE_UNIFORMS, &count);
+  glGetProgramiv(id_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+  std::vector<char> name(max_length + 1);
+  for (int i = 0; i < count; i++) {
+    int    length = 0;
+    int    size   = 0;
+    GLenum type   = 0;
+    glGetActiveUniform(id_, i, static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+
+    UniformInfo info;
+    info.name     = std::string(name.data(), length);
+    info.location = glGetUniformLocation(id_, info.name.c_str());
+    info.type     = type;
+    info.size     = size;
+
+    // Members of uniform blocks have no location, they are set through the block's buffer.
+    if (info.location < 0) continue;
+
+    if (info.name.size() > 3 && info.name.compare(info.name.size() - 3, 3, "[0]") == 0) {
+      info.name.resize(info.name.size() - 3);
+    }
+    uniforms_.push_back(std::move(info));
+  }
+
+  std::sort(uniforms_.begin(), uniforms_.end(),
+            [](const UniformInfo &a, const UniformInfo &b) { return a.name < b.name; });
+}
+
+UniformHandle Shader::GetUniformHandle(const std::string &name) const {
+  auto it = std::lower_bound(uniforms_.begin(), uniforms_.end(), name,
+                             [](const UniformInfo &info, const std::string &key) { return info.name < key; });
+  if (it == uniforms_.end() || it->name != name) return UniformHandle{};
+  return UniformHandle{it->location};
+}
+
+void Shader::BindUniformBlock(const std::string &block, unsigned int binding) {
+  unsigned int index = glGetUniformBlockIndex(id_, block.c_str());
+  if (index == GL_INVALID_INDEX) {
+    logger_->warn("Uniform block '{}' not found in shader '{}'", block, name_);
+    return;
+  }
+  glUniformBlockBinding(id_, index, binding);
+}
+
+void Shader::SetUniform(UniformHandle handle, int value) { glProgramUniform1i(id_, handle.location, value); }
+
+void Shader::SetUniform(UniformHandle handle, float value) { glProgramUniform1f(id_, handle.location, value); }
+
+void Shader::SetUniform(UniformHandle handle, const glm::vec2 &value) {
+  glProgramUniform2f(id_, handle.location, value.x, value.y);
+}
+
+void Shader::SetUniform(UniformHandle handle, const glm::vec3 &value) {
+  glProgramUniform3f(id_, handle.location, value.x, value.y, value.z);
+}
+
+void Shader::SetUniform(UniformHandle handle, const glm::vec4 &value) {
+  glProgramUniform4f(id_, handle.location, value.x, value.y, value.z, value.w);
+}
+
+void Shader::SetUniform(UniformHandle handle, const glm::mat4 &value) {
+  glProgramUniformMatrix4fv(id_, handle.location, 1, GL_FALSE, &value[0][0]);
+}
+
+void Shader::SetUniformArray(UniformHandle handle, const int *values, int count) {
+  glProgramUniform1iv(id_, handle.location, count, values);
+}
+
+std::string Shader::inject_defines(const std::string &source, const ShaderDefines &defines) {
+  if (defines.empty()) return source;
+
+  std::string block;
+  for (const auto &[name, value] : defines) {
+    block += "#define " + name + " " + value + "\n";
+  }
+
+  // GLSL requires #version to stay the first statement, so the defines go right after it.
+  size_t pos = 0;
+  if (source.compare(0, 8, "#version") == 0) {
+    pos = source.find('\n');
+    pos = pos == std::string::npos ? source.size() : pos + 1;
+  }
+  std::string result = source;
+  result.insert(pos, block);
+  return result;
+}
+
+Shader::~Shader() {
+  RenderState::OnDeleteProgram(id_);
+  glDeleteProgram(id_);
+}
 
-void Shader::Bind() { glUseProgram(id_); }
+void Shader::Bind() { RenderState::UseProgram(id_); }
 
-void Shader::Unbind() { glUseProgram(0); }
+void Shader::Unbind() { RenderState::UseProgram(0); }
 
 std::vector<char> Shader::read_file(const std::string &path) {
   std::ifstream file(path, std::ios::ate | std::ios::binary);
@@ -17,16 +17,45 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "core/logger.hpp"
 
 namespace MEngine {
 
+/**
+ * @brief Preprocessor definitions inserted after the `#version` line of every stage.
+ *
+ */
+using ShaderDefines = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * @brief Resolved location of a uniform, obtained once through Shader::GetUniformHandle().
+ *
+ */
+struct UniformHandle {
+  int location = -1;
+
+  bool IsValid() const { return location >= 0; }
+};
+
+/**
+ * @brief An active uniform of a linked program, collected once after linking.
+ *
+ */
+struct UniformInfo {
+  std::string name;
+  int         location;
+  GLenum      type;
+  int         size;
+};
+
 class Shader {
  public:
-  Shader(const std::string &vert_path, const std::string &frag_path);
-  Shader(const std::string &name, const std::string &vert_path, const std::string &frag_path);
+  Shader(const std::string &vert_path, const std::string &frag_path, const ShaderDefines &defines = {});
+  Shader(const std::string &name, const std::string &vert_path, const std::string &frag_path,
+         const ShaderDefines &defines = {});
   ~Shader();
 
   void Bind();
@@ -38,6 +67,34 @@ class Shader {
 
   const std::string &GetName() const { return name_; }
 
+  /**
+   * @brief Look the uniform up in the reflected table. Arrays are found by their
+   * name without the `[0]` suffix. Cache the handle outside of hot loops.
+   *
+   */
+  UniformHandle GetUniformHandle(const std::string &name) const;
+
+  const std::vector<UniformInfo> &GetUniforms() const { return uniforms_; }
+
+  /**
+   * @brief Attach the uniform block `block` to the uniform buffer binding point `binding`.
+   *
+   */
+  void BindUniformBlock(const std::string &block, unsigned int binding);
+
+  // The handle setters write through glProgramUniform*, the shader does not need to be bound.
+  void SetUniform(UniformHandle handle, int value);
+  void SetUniform(UniformHandle handle, float value);
+  void SetUniform(UniformHandle handle, const glm::vec2 &value);
+  void SetUniform(UniformHandle handle, const glm::vec3 &value);
+  void SetUniform(UniformHandle handle, const glm::vec4 &value);
+  void SetUniform(UniformHandle handle, const glm::mat4 &value);
+  void SetUniformArray(UniformHandle handle, const int *values, int count);
+
+  void SetUniformArray(const std::string &name, const int *values, int count) {
+    SetUniformArray(GetUniformHandle(name), values, count);
+  }
+
   template <typename T>
   void SetUniform(const std::string &name, T value) {
     logger_->error("SetUniform not implemented for this type");
@@ -45,53 +102,53 @@ class Shader {
 
   template <>
   void SetUniform<int>(const std::string &name, int value) {
-    Bind();
-    int location = glGetUniformLocation(id_, name.c_str());
-    glUniform1i(location, value);
+    SetUniform(GetUniformHandle(name), value);
   }
 
   template <>
   void SetUniform<float>(const std::string &name, float value) {
-    Bind();
-    int location = glGetUniformLocation(id_, name.c_str());
-    glUniform1f(location, value);
+    SetUniform(GetUniformHandle(name), value);
   }
 
   template <>
   void SetUniform<glm::vec2>(const std::string &name, glm::vec2 value) {
-    Bind();
-    int location = glGetUniformLocation(id_, name.c_str());
-    glUniform2f(location, value.x, value.y);
+    SetUniform(GetUniformHandle(name), value);
   }
 
   template <>
   void SetUniform<glm::vec3>(const std::string &name, glm::vec3 value) {
-    Bind();
-    int location = glGetUniformLocation(id_, name.c_str());
-    glUniform3f(location, value.x, value.y, value.z);
+    SetUniform(GetUniformHandle(name), value);
   }
 
   template <>
   void SetUniform<glm::vec4>(const std::string &name, glm::vec4 value) {
-    Bind();
-    int location = glGetUniformLocation(id_, name.c_str());
-    glUniform4f(location, value.x, value.y, value.z, value.w);
+    SetUniform(GetUniformHandle(name), value);
   }
 
   template <>
   void SetUniform<glm::mat4>(const std::string &name, glm::mat4 value) {
-    Bind();
-    int location = glGetUniformLocation(id_, name.c_str());
-    glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+    SetUniform(GetUniformHandle(name), value);
   }
 
  private:
   unsigned int id_;
 
+  void compile(const ShaderDefines &defines);
+
+  void reflect_uniforms();
+
   static std::vector<char> read_file(const std::string &path);
 
+  static std::string inject_defines(const std::string &source, const ShaderDefines &defines);
+
   std::string name_;
 
+  /**
+   * @brief Active uniforms sorted by name.
+   *
+   */
+  std::vector<UniformInfo> uniforms_;
+
   std::shared_ptr<spdlog::logger> logger_;
 
   std::string vert_path_;
@@ -0,0 +1,404 @@
+#include "render/sprite_kernel.hpp"
+
+#include <cmath>
+
+#include "render/renderer.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MENGINE_SPRITE_KERNEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MENGINE_TARGET_SSE2 __attribute__((target("sse2")))
+#define MENGINE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define MENGINE_TARGET_SSE2
+#define MENGINE_TARGET_AVX2
+#endif
+
+namespace MEngine {
+
+SpriteStreams SpriteStreams::Slice(size_t first, size_t count) const {
+  SpriteStreams slice = *this;
+  slice.position_x    = position_x + first;
+  slice.position_y    = position_y + first;
+  slice.position_z    = position_z + first;
+  slice.scale_x       = scale_x + first;
+  slice.scale_y       = scale_y + first;
+  slice.rotation      = rotation + first;
+  slice.color         = color + first;
+  slice.uv_rect       = uv_rect ? uv_rect + first : nullptr;
+  slice.count         = count;
+  return slice;
+}
+
+void SpriteStreamBuffer::Clear() {
+  position_x.clear();
+  position_y.clear();
+  position_z.clear();
+  scale_x.clear();
+  scale_y.clear();
+  rotation.clear();
+  color.clear();
+  uv_rect.clear();
+}
+
+void SpriteStreamBuffer::Push(const glm::vec3 &position, float rotation, const glm::vec2 &scale,
+                              const glm::vec4 &color, const glm::vec4 &uv_rect) {
+  position_x.push_back(position.x);
+  position_y.push_back(position.y);
+  position_z.push_back(position.z);
+  scale_x.push_back(scale.x);
+  scale_y.push_back(scale.y);
+  this->rotation.push_back(rotation);
+  this->color.push_back(color);
+  this->uv_rect.push_back(uv_rect);
+}
+
+SpriteStreams SpriteStreamBuffer::GetStreams() const {
+  SpriteStreams streams;
+  streams.position_x = position_x.data();
+  streams.position_y = position_y.data();
+  streams.position_z = position_z.data();
+  streams.scale_x    = scale_x.data();
+  streams.scale_y    = scale_y.data();
+  streams.rotation   = rotation.data();
+  streams.color      = color.data();
+  streams.uv_rect    = uv_rect.data();
+  streams.count      = Size();
+  return streams;
+}
+
+static const glm::vec4 s_full_uv_rect(0.0f, 0.0f, 1.0f, 1.0f);
+
+/**
+ * @brief Corners in the order bottom left, bottom right, top right, top left.
+ *
+ */
+static inline void write_quad(QuadVertex *vertex, const float x[4], const float y[4], float z, const glm::vec4 &color,
+                              const glm::vec4 &uv, float tex_index) {
+  const glm::vec2 tex_coords[4] = {{uv.x, uv.y}, {uv.z, uv.y}, {uv.z, uv.w}, {uv.x, uv.w}};
+  for (int corner = 0; corner < 4; corner++, vertex++) {
+    vertex->position  = glm::vec3(x[corner], y[corner], z);
+    vertex->color     = color;
+    vertex->tex_coord = tex_coords[corner];
+    vertex->tex_index = tex_index;
+  }
+}
+
+static void emit_range_scalar(const SpriteStreams &sprites, size_t begin, float tex_index, QuadVertex *out) {
+  for (size_t i = begin; i < sprites.count; i++) {
+    float c  = std::cos(sprites.rotation[i]);
+    float s  = std::sin(sprites.rotation[i]);
+    float ax = 0.5f * c * sprites.scale_x[i];
+    float ay = 0.5f * s * sprites.scale_x[i];
+    float bx = -0.5f * s * sprites.scale_y[i];
+    float by = 0.5f * c * sprites.scale_y[i];
+    float px = sprites.position_x[i];
+    float py = sprites.position_y[i];
+
+    const float x[4] = {px - ax - bx, px + ax - bx, px + ax + bx, px - ax + bx};
+    const float y[4] = {py - ay - by, py + ay - by, py + ay + by, py - ay + by};
+    write_quad(out + 4 * i, x, y, sprites.position_z[i], sprites.color[i],
+               sprites.uv_rect ? sprites.uv_rect[i] : s_full_uv_rect, tex_index);
+  }
+}
+
+void SpriteKernel::EmitQuadsScalar(const SpriteStreams &sprites, float tex_index, QuadVertex *out) {
+  emit_range_scalar(sprites, 0, tex_index, out);
+}
+
+// sin/cos on [-pi/4, pi/4] after a three part reduction by pi/2 (Cephes sinf/cosf coefficients).
+static constexpr float kTwoOverPi = 0.636619772367581f;
+static constexpr float kPiOver2A  = 1.5703125f;
+static constexpr float kPiOver2B  = 4.837512969970703125e-4f;
+static constexpr float kPiOver2C  = 7.54978995489188216e-8f;
+static constexpr float kSin1      = -1.6666654611e-1f;
+static constexpr float kSin2      = 8.3321608736e-3f;
+static constexpr float kSin3      = -1.9515295891e-4f;
+static constexpr float kCos1      = 4.166664568298827e-2f;
+static constexpr float kCos2      = -1.388731625493765e-3f;
+static constexpr float kCos3      = 2.443315711809948e-5f;
+
+#if defined(MENGINE_SPRITE_KERNEL_X86)
+
+MENGINE_TARGET_SSE2 static inline void sincos_sse2(__m128 x, __m128 &sin_out, __m128 &cos_out) {
+  __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(kTwoOverPi)));
+  __m128  j        = _mm_cvtepi32_ps(quadrant);
+
+  __m128 r = _mm_sub_ps(x, _mm_mul_ps(j, _mm_set1_ps(kPiOver2A)));
+  r        = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(kPiOver2B)));
+  r        = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(kPiOver2C)));
+
+  __m128 r2    = _mm_mul_ps(r, r);
+  __m128 sin_r = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(kSin3)), _mm_set1_ps(kSin2));
+  sin_r        = _mm_add_ps(_mm_mul_ps(sin_r, r2), _mm_set1_ps(kSin1));
+  sin_r        = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sin_r, r2), r), r);
+
+  __m128 cos_r = _mm_add_ps(_mm_mul_ps(r2, _mm_set1_ps(kCos3)), _mm_set1_ps(kCos2));
+  cos_r        = _mm_add_ps(_mm_mul_ps(cos_r, r2), _mm_set1_ps(kCos1));
+  cos_r        = _mm_mul_ps(_mm_mul_ps(cos_r, r2), r2);
+  cos_r        = _mm_add_ps(_mm_sub_ps(cos_r, _mm_mul_ps(r2, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+  // Odd quadrants swap sin and cos, the sign comes from bit 1 of the quadrant (and of quadrant + 1 for cos).
+  const __m128i one  = _mm_set1_epi32(1);
+  const __m128i two  = _mm_set1_epi32(2);
+  __m128        swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+  __m128        s    = _mm_or_ps(_mm_and_ps(swap, cos_r), _mm_andnot_ps(swap, sin_r));
+  __m128        c    = _mm_or_ps(_mm_and_ps(swap, sin_r), _mm_andnot_ps(swap, cos_r));
+
+  __m128 sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+  __m128 cos_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+  sin_out         = _mm_xor_ps(s, sin_sign);
+  cos_out         = _mm_xor_ps(c, cos_sign);
+}
+
+static_assert(sizeof(QuadVertex) == 10 * sizeof(float), "the vector stores assume a tightly packed QuadVertex");
+
+/**
+ * @brief write_quad() as ten 16 byte stores. The target is usually mapped, write combined
+ * memory, where whole vector writes cost far less than one store per field.
+ *
+ */
+MENGINE_TARGET_SSE2 static inline void store_quad_sse2(QuadVertex *vertex, const float x[4], const float y[4], float z,
+                                                       const glm::vec4 &color, const glm::vec4 &uv, float tex_index) {
+  const float u[4] = {uv.x, uv.z, uv.z, uv.x};
+  const float v[4] = {uv.y, uv.y, uv.w, uv.w};
+
+  // Per vertex: x y z | r g b a | u v | tex_index, so the 40 floats repeat with a period of two vertices.
+  float       *out  = reinterpret_cast<float *>(vertex);
+  const __m128 zrgb = _mm_setr_ps(z, color.x, color.y, color.z);
+  _mm_storeu_ps(out + 0, _mm_setr_ps(x[0], y[0], z, color.x));
+  _mm_storeu_ps(out + 4, _mm_setr_ps(color.y, color.z, color.w, u[0]));
+  _mm_storeu_ps(out + 8, _mm_setr_ps(v[0], tex_index, x[1], y[1]));
+  _mm_storeu_ps(out + 12, zrgb);
+  _mm_storeu_ps(out + 16, _mm_setr_ps(color.w, u[1], v[1], tex_index));
+  _mm_storeu_ps(out + 20, _mm_setr_ps(x[2], y[2], z, color.x));
+  _mm_storeu_ps(out + 24, _mm_setr_ps(color.y, color.z, color.w, u[2]));
+  _mm_storeu_ps(out + 28, _mm_setr_ps(v[2], tex_index, x[3], y[3]));
+  _mm_storeu_ps(out + 32, zrgb);
+  _mm_storeu_ps(out + 36, _mm_setr_ps(color.w, u[3], v[3], tex_index));
+}
+
+MENGINE_TARGET_SSE2 void SpriteKernel::EmitQuadsSSE2(const SpriteStreams &sprites, float tex_index,
+                                                     QuadVertex *out) {
+  const __m128 half = _mm_set1_ps(0.5f);
+
+  size_t i = 0;
+  for (; i + 4 <= sprites.count; i += 4) {
+    __m128 px = _mm_loadu_ps(sprites.position_x + i);
+    __m128 py = _mm_loadu_ps(sprites.position_y + i);
+    __m128 sx = _mm_mul_ps(_mm_loadu_ps(sprites.scale_x + i), half);
+    __m128 sy = _mm_mul_ps(_mm_loadu_ps(sprites.scale_y + i), half);
+
+    __m128 s, c;
+    sincos_sse2(_mm_loadu_ps(sprites.rotation + i), s, c);
+
+    // Half axes of the quad: a = (c, s) * sx / 2, b = (-s, c) * sy / 2.
+    __m128 ax = _mm_mul_ps(c, sx);
+    __m128 ay = _mm_mul_ps(s, sx);
+    __m128 bx = _mm_mul_ps(s, sy);  // negated below
+    __m128 by = _mm_mul_ps(c, sy);
+
+    alignas(16) float x[4][4];
+    alignas(16) float y[4][4];
+    _mm_store_ps(x[0], _mm_add_ps(_mm_sub_ps(px, ax), bx));
+    _mm_store_ps(x[1], _mm_add_ps(_mm_add_ps(px, ax), bx));
+    _mm_store_ps(x[2], _mm_sub_ps(_mm_add_ps(px, ax), bx));
+    _mm_store_ps(x[3], _mm_sub_ps(_mm_sub_ps(px, ax), bx));
+    _mm_store_ps(y[0], _mm_sub_ps(_mm_sub_ps(py, ay), by));
+    _mm_store_ps(y[1], _mm_sub_ps(_mm_add_ps(py, ay), by));
+    _mm_store_ps(y[2], _mm_add_ps(_mm_add_ps(py, ay), by));
+    _mm_store_ps(y[3], _mm_add_ps(_mm_sub_ps(py, ay), by));
+
+    for (int lane = 0; lane < 4; lane++) {
+      const float corner_x[4] = {x[0][lane], x[1][lane], x[2][lane], x[3][lane]};
+      const float corner_y[4] = {y[0][lane], y[1][lane], y[2][lane], y[3][lane]};
+      store_quad_sse2(out + 4 * (i + lane), corner_x, corner_y, sprites.position_z[i + lane],
+                      sprites.color[i + lane], sprites.uv_rect ? sprites.uv_rect[i + lane] : s_full_uv_rect,
+                      tex_index);
+    }
+  }
+
+  emit_range_scalar(sprites, i, tex_index, out);
+}
+
+MENGINE_TARGET_AVX2 static inline void sincos_avx2(__m256 x, __m256 &sin_out, __m256 &cos_out) {
+  __m256i quadrant = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(kTwoOverPi)));
+  __m256  j        = _mm256_cvtepi32_ps(quadrant);
+
+  __m256 r = _mm256_fnmadd_ps(j, _mm256_set1_ps(kPiOver2A), x);
+  r        = _mm256_fnmadd_ps(j, _mm256_set1_ps(kPiOver2B), r);
+  r        = _mm256_fnmadd_ps(j, _mm256_set1_ps(kPiOver2C), r);
+
+  __m256 r2    = _mm256_mul_ps(r, r);
+  __m256 sin_r = _mm256_fmadd_ps(r2, _mm256_set1_ps(kSin3), _mm256_set1_ps(kSin2));
+  sin_r        = _mm256_fmadd_ps(sin_r, r2, _mm256_set1_ps(kSin1));
+  sin_r        = _mm256_fmadd_ps(_mm256_mul_ps(sin_r, r2), r, r);
+
+  __m256 cos_r = _mm256_fmadd_ps(r2, _mm256_set1_ps(kCos3), _mm256_set1_ps(kCos2));
+  cos_r        = _mm256_fmadd_ps(cos_r, r2, _mm256_set1_ps(kCos1));
+  cos_r        = _mm256_mul_ps(_mm256_mul_ps(cos_r, r2), r2);
+  cos_r        = _mm256_add_ps(_mm256_fnmadd_ps(r2, _mm256_set1_ps(0.5f), cos_r), _mm256_set1_ps(1.0f));
+
+  const __m256i one  = _mm256_set1_epi32(1);
+  const __m256i two  = _mm256_set1_epi32(2);
+  __m256        swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one));
+  __m256        s    = _mm256_blendv_ps(sin_r, cos_r, swap);
+  __m256        c    = _mm256_blendv_ps(cos_r, sin_r, swap);
+
+  __m256 sin_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, two), 30));
+  __m256 cos_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, one), two), 30));
+  sin_out         = _mm256_xor_ps(s, sin_sign);
+  cos_out         = _mm256_xor_ps(c, cos_sign);
+}
+
+/**
+ * @brief write_quad() as five 32 byte stores.
+ *
+ */
+MENGINE_TARGET_AVX2 static inline void store_quad_avx2(QuadVertex *vertex, const float x[4], const float y[4], float z,
+                                                       const glm::vec4 &color, const glm::vec4 &uv, float tex_index) {
+  const float u[4] = {uv.x, uv.z, uv.z, uv.x};
+  const float v[4] = {uv.y, uv.y, uv.w, uv.w};
+
+  float *out = reinterpret_cast<float *>(vertex);
+  _mm256_storeu_ps(out + 0, _mm256_setr_ps(x[0], y[0], z, color.x, color.y, color.z, color.w, u[0]));
+  _mm256_storeu_ps(out + 8, _mm256_setr_ps(v[0], tex_index, x[1], y[1], z, color.x, color.y, color.z));
+  _mm256_storeu_ps(out + 16, _mm256_setr_ps(color.w, u[1], v[1], tex_index, x[2], y[2], z, color.x));
+  _mm256_storeu_ps(out + 24, _mm256_setr_ps(color.y, color.z, color.w, u[2], v[2], tex_index, x[3], y[3]));
+  _mm256_storeu_ps(out + 32, _mm256_setr_ps(z, color.x, color.y, color.z, color.w, u[3], v[3], tex_index));
+}
+
+MENGINE_TARGET_AVX2 void SpriteKernel::EmitQuadsAVX2(const SpriteStreams &sprites, float tex_index,
+                                                     QuadVertex *out) {
+  const __m256 half = _mm256_set1_ps(0.5f);
+
+  size_t i = 0;
+  for (; i + 8 <= sprites.count; i += 8) {
+    __m256 px = _mm256_loadu_ps(sprites.position_x + i);
+    __m256 py = _mm256_loadu_ps(sprites.position_y + i);
+    __m256 sx = _mm256_mul_ps(_mm256_loadu_ps(sprites.scale_x + i), half);
+    __m256 sy = _mm256_mul_ps(_mm256_loadu_ps(sprites.scale_y + i), half);
+
+    __m256 s, c;
+    sincos_avx2(_mm256_loadu_ps(sprites.rotation + i), s, c);
+
+    __m256 ax = _mm256_mul_ps(c, sx);
+    __m256 ay = _mm256_mul_ps(s, sx);
+    __m256 bx = _mm256_mul_ps(s, sy);  // negated below
+    __m256 by = _mm256_mul_ps(c, sy);
+
+    alignas(32) float x[4][8];
+    alignas(32) float y[4][8];
+    _mm256_store_ps(x[0], _mm256_add_ps(_mm256_sub_ps(px, ax), bx));
+    _mm256_store_ps(x[1], _mm256_add_ps(_mm256_add_ps(px, ax), bx));
+    _mm256_store_ps(x[2], _mm256_sub_ps(_mm256_add_ps(px, ax), bx));
+    _mm256_store_ps(x[3], _mm256_sub_ps(_mm256_sub_ps(px, ax), bx));
+    _mm256_store_ps(y[0], _mm256_sub_ps(_mm256_sub_ps(py, ay), by));
+    _mm256_store_ps(y[1], _mm256_sub_ps(_mm256_add_ps(py, ay), by));
+    _mm256_store_ps(y[2], _mm256_add_ps(_mm256_add_ps(py, ay), by));
+    _mm256_store_ps(y[3], _mm256_add_ps(_mm256_sub_ps(py, ay), by));
+
+    for (int lane = 0; lane < 8; lane++) {
+      const float corner_x[4] = {x[0][lane], x[1][lane], x[2][lane], x[3][lane]};
+      const float corner_y[4] = {y[0][lane], y[1][lane], y[2][lane], y[3][lane]};
+      store_quad_avx2(out + 4 * (i + lane), corner_x, corner_y, sprites.position_z[i + lane],
+                      sprites.color[i + lane], sprites.uv_rect ? sprites.uv_rect[i + lane] : s_full_uv_rect,
+                      tex_index);
+    }
+  }
+
+  emit_range_scalar(sprites, i, tex_index, out);
+}
+
+static bool cpu_has_sse2() {
+#if defined(__x86_64__) || defined(_M_X64)
+  return true;
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  return (info[3] & (1 << 26)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse2");
+#endif
+}
+
+static bool cpu_has_avx2() {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) return false;
+
+  // FMA and OS support for saving the ymm registers.
+  __cpuid(info, 1);
+  bool fma     = (info[2] & (1 << 12)) != 0;
+  bool osxsave = (info[2] & (1 << 27)) != 0;
+  if (!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+#else
+
+void SpriteKernel::EmitQuadsSSE2(const SpriteStreams &sprites, float tex_index, QuadVertex *out) {
+  emit_range_scalar(sprites, 0, tex_index, out);
+}
+
+void SpriteKernel::EmitQuadsAVX2(const SpriteStreams &sprites, float tex_index, QuadVertex *out) {
+  emit_range_scalar(sprites, 0, tex_index, out);
+}
+
+static bool cpu_has_sse2() { return false; }
+
+static bool cpu_has_avx2() { return false; }
+
+#endif
+
+SpriteKernel::Isa SpriteKernel::Detect() {
+  static const Isa isa = cpu_has_avx2() ? Isa::AVX2 : cpu_has_sse2() ? Isa::SSE2 : Isa::Scalar;
+  return isa;
+}
+
+static SpriteKernel::Isa s_isa = SpriteKernel::Detect();
+
+SpriteKernel::Isa SpriteKernel::GetIsa() { return s_isa; }
+
+void SpriteKernel::SetIsa(Isa isa) { s_isa = static_cast<int>(isa) <= static_cast<int>(Detect()) ? isa : Detect(); }
+
+const char *SpriteKernel::GetIsaName(Isa isa) {
+  switch (isa) {
+    case Isa::AVX2:
+      return "AVX2";
+    case Isa::SSE2:
+      return "SSE2";
+    default:
+      return "Scalar";
+  }
+}
+
+void SpriteKernel::EmitQuads(const SpriteStreams &sprites, float tex_index, QuadVertex *out) {
+  switch (s_isa) {
+    case Isa::AVX2:
+      EmitQuadsAVX2(sprites, tex_index, out);
+      break;
+    case Isa::SSE2:
+      EmitQuadsSSE2(sprites, tex_index, out);
+      break;
+    default:
+      EmitQuadsScalar(sprites, tex_index, out);
+      break;
+  }
+}
+
+}  // namespace MEngine
@@ -0,0 +1,118 @@
+/**
+ * @file sprite_kernel.hpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2024-08-14
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace MEngine {
+
+struct QuadVertex;
+
+/**
+ * @brief Structure of arrays view over sprites that only rotate around z.
+ *
+ */
+struct SpriteStreams {
+  const float     *position_x = nullptr;
+  const float     *position_y = nullptr;
+  const float     *position_z = nullptr;
+  const float     *scale_x    = nullptr;
+  const float     *scale_y    = nullptr;
+  const float     *rotation   = nullptr;  // radians
+  const glm::vec4 *color      = nullptr;
+  const glm::vec4 *uv_rect    = nullptr;  // optional (u0, v0, u1, v1), the whole texture when nullptr
+
+  size_t count = 0;
+
+  /**
+   * @brief View of `count` sprites starting at `first`.
+   *
+   */
+  SpriteStreams Slice(size_t first, size_t count) const;
+};
+
+/**
+ * @brief Owns the arrays a SpriteStreams points into, kept around so refilling it every frame does not allocate.
+ *
+ */
+struct SpriteStreamBuffer {
+  std::vector<float>     position_x;
+  std::vector<float>     position_y;
+  std::vector<float>     position_z;
+  std::vector<float>     scale_x;
+  std::vector<float>     scale_y;
+  std::vector<float>     rotation;
+  std::vector<glm::vec4> color;
+  std::vector<glm::vec4> uv_rect;
+
+  void Clear();
+
+  void Push(const glm::vec3 &position, float rotation, const glm::vec2 &scale, const glm::vec4 &color,
+            const glm::vec4 &uv_rect);
+
+  size_t Size() const { return position_x.size(); }
+
+  /**
+   * @brief View of the content, invalidated by the next Push().
+   *
+   */
+  SpriteStreams GetStreams() const;
+};
+
+/**
+ * @brief Builds the four QuadVertex of each sprite from position, scale and
+ * rotation, 4 or 8 sprites at a time when the CPU allows it. The SIMD paths
+ * also write the vertices with whole vector stores.
+ *
+ */
+class SpriteKernel {
+ public:
+  enum class Isa {
+    Scalar,
+    SSE2,
+    AVX2,
+  };
+
+  /**
+   * @brief Best instruction set supported by this CPU and build.
+   *
+   */
+  static Isa Detect();
+
+  /**
+   * @brief Instruction set used by EmitQuads, Detect() unless overridden.
+   *
+   */
+  static Isa GetIsa();
+
+  /**
+   * @brief Force an instruction set, clamped to what Detect() allows.
+   *
+   */
+  static void SetIsa(Isa isa);
+
+  static const char *GetIsaName(Isa isa);
+
+  /**
+   * @brief Write 4 * sprites.count vertices to `out` in the winding of the batched quad index buffer.
+   *
+   */
+  static void EmitQuads(const SpriteStreams &sprites, float tex_index, QuadVertex *out);
+
+  static void EmitQuadsScalar(const SpriteStreams &sprites, float tex_index, QuadVertex *out);
+  static void EmitQuadsSSE2(const SpriteStreams &sprites, float tex_index, QuadVertex *out);
+  static void EmitQuadsAVX2(const SpriteStreams &sprites, float tex_index, QuadVertex *out);
+};
+
+}  // namespace MEngine
@@ -2,19 +2,18 @@
 
 #include <glad/glad.h>
 
-#include <glm/glm.hpp>
-#include <vector>
+#include "render/render_state.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 namespace MEngine {
 
-Texture::Texture(const std::string &path) : path_(path) {
+Texture::Texture(const std::string &path) : path_(path), data_(nullptr) {
   logger_ = Logger::Get("Texture");
 
   glGenTextures(1, &id_);
-  glBindTexture(GL_TEXTURE_2D, id_);
+  RenderState::BindTexture(0, id_);
 
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -49,7 +48,7 @@ Texture::Texture(const std::string &name, const std::string &path) {
   logger_ = Logger::Get("Texture");
 
   glGenTextures(1, &id_);
-  glBindTexture(GL_TEXTURE_2D, id_);
+  RenderState::BindTexture(0, id_);
 
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -78,9 +77,9 @@ Texture::Texture(const std::string &name, const std::string &path) {
   name_ = name;
 }
 
-Texture::Texture() {
+Texture::Texture() : width_(0), height_(0), channels_(0), data_(nullptr) {
   glGenTextures(1, &id_);
-  glBindTexture(GL_TEXTURE_2D, id_);
+  RenderState::BindTexture(0, id_);
 
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -89,51 +88,32 @@ Texture::Texture() {
 }
 
 Texture::~Texture() {
+  RenderState::OnDeleteTexture(id_);
   glDeleteTextures(1, &id_);
   stbi_image_free(data_);
 }
 
-void Texture::SetData(unsigned char *data, int width, int height) {
-  data_     = data;
+void Texture::SetData(unsigned char *data, int width, int height, int channels) {
+  // The pixels are owned by the caller, so only the GL copy is kept.
   width_    = width;
   height_   = height;
-  channels_ = 4;
+  channels_ = channels;
 
-  glBindTexture(GL_TEXTURE_2D, id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data_);
+  GLenum format = GL_RGBA;
+  if (channels_ == 1) {
+    format = GL_RED;
+  } else if (channels_ == 3) {
+    format = GL_RGB;
+  }
+
+  RenderState::BindTexture(0, id_);
+  glTexImage2D(GL_TEXTURE_2D, 0, format, width_, height_, 0, format, GL_UNSIGNED_BYTE, data);
   glGenerateMipmap(GL_TEXTURE_2D);
 }
 
-void Texture::Bind(unsigned int slot) const {
-  glActiveTexture(GL_TEXTURE0 + slot);
-  glBindTexture(GL_TEXTURE_2D, id_);
-}
+void Texture::Bind(unsigned int slot) const { RenderState::BindTexture(slot, id_); }
 
-void Texture::Unbind() const { glBindTexture(GL_TEXTURE_2D, 0); }
-
-void Texture::SetSubTexture(int frame) {
-  int w = width_ / h_frames_;
-  int h = height_ / v_frames_;
-  int x = frame % h_frames_;
-  int y = (frame / h_frames_) % v_frames_;
-
-  std::vector<glm::vec2> uv = {
-      {x * w, y * h + h},
-      {x * w + w, y * h + h},
-      {x * w + w, y * h},
-      {x * w, y * h},
-  };
-
-  glBindTexture(GL_TEXTURE_2D, id_);
-  void *gpu_buffer = nullptr;
-  gpu_buffer       = glMapBufferRange(GL_ARRAY_BUFFER, 0, sizeof(uv), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
-  memcpy(gpu_buffer, uv.data(), sizeof(uv));
-  glUnmapBuffer(GL_ARRAY_BUFFER);
-  // glTexSubImage2D(GL_TEXTURE_2D, 0, x * w, y * h, w, h, GL_RGBA,
-  //                 GL_UNSIGNED_BYTE, data_);
-  // glTextureSubImage2D(id_, 0, x * w, y * h, w, h, GL_RGBA, GL_UNSIGNED_BYTE,
-  //                     data_);
-}
+void Texture::Unbind(unsigned int slot) const { RenderState::BindTexture(slot, 0); }
 
 std::shared_ptr<Texture> Texture::Create(const std::string &path) { return std::make_shared<Texture>(path); }
 
@@ -163,4 +143,4 @@ std::shared_ptr<Texture> TextureLibrary::Get(const std::string &name) { return t
 
 bool TextureLibrary::Exists(const std::string &name) const { return textures_.find(name) != textures_.end(); }
 
-}  // namespace MEngine
\ No newline at end of file
+}  // namespace MEngine
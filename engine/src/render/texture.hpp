@@ -11,8 +11,10 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "core/logger.hpp"
 
@@ -24,30 +26,35 @@ class Texture {
 
   Texture(const std::string &name, const std::string &path);
 
-  void SetData(unsigned char *data, int width, int height);
+  /**
+   * @brief Upload `width` x `height` pixels of `channels` bytes each (1, 3 or 4).
+   *
+   */
+  void SetData(unsigned char *data, int width, int height, int channels = 4);
 
   Texture();
 
   ~Texture();
 
   void Bind(unsigned int slot = 0) const;
-  void Unbind() const;
+  void Unbind(unsigned int slot = 0) const;
 
   int GetWidth() const { return width_; }
 
   int GetHeight() const { return height_; }
 
-  void SetVFrames(int v_frames) { v_frames_ = v_frames; }
-  void SetHFrames(int h_frames) { h_frames_ = h_frames; }
-
-  void SetSubTexture(int frame = 0);
-
   const std::string &GetName() const { return name_; }
 
   std::string GetPath() const { return path_; }
 
   const unsigned int GetID() const { return id_; }
 
+  /**
+   * @brief Whether the image has an alpha channel, such textures are drawn with the translucent quads.
+   *
+   */
+  bool HasAlpha() const { return channels_ == 4; }
+
   static std::shared_ptr<Texture> Create(const std::string &path);
 
  private:
@@ -56,9 +63,6 @@ class Texture {
   int          height_;
   int          channels_;
 
-  int v_frames_ = 1;
-  int h_frames_ = 1;
-
   std::shared_ptr<spdlog::logger> logger_;
 
   std::string path_;
@@ -89,4 +93,10 @@ class TextureLibrary {
   std::shared_ptr<spdlog::logger> logger_;
 };
 
-}  // namespace MEngine
\ No newline at end of file
+/**
+ * @brief Generational 32-bit reference to a texture owned by the AssetManager, 0 means untextured.
+ *
+ */
+using TextureHandle = uint32_t;
+
+}  // namespace MEngine
@@ -0,0 +1,53 @@
+/**
+ * @file bounds.hpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2024-08-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace MEngine {
+
+/**
+ * @brief Axis aligned rectangle on the xy plane.
+ *
+ */
+struct Bounds2D {
+  glm::vec2 min = {0.0f, 0.0f};
+  glm::vec2 max = {0.0f, 0.0f};
+
+  Bounds2D() = default;
+  Bounds2D(const glm::vec2 &min, const glm::vec2 &max) : min(min), max(max) {}
+
+  static Bounds2D FromCenter(const glm::vec2 &center, const glm::vec2 &half_extents) {
+    return Bounds2D(center - half_extents, center + half_extents);
+  }
+
+  /**
+   * @brief Bounds of the unit quad ([-0.5, 0.5]^2) transformed by `model`.
+   *
+   */
+  static Bounds2D FromQuad(const glm::mat4 &model) {
+    glm::vec2 half_extents = 0.5f * (glm::abs(glm::vec2(model[0])) + glm::abs(glm::vec2(model[1])));
+    return FromCenter(glm::vec2(model[3]), half_extents);
+  }
+
+  Bounds2D Merged(const Bounds2D &other) const { return Bounds2D(glm::min(min, other.min), glm::max(max, other.max)); }
+
+  bool Overlaps(const Bounds2D &other) const {
+    return min.x <= other.max.x && max.x >= other.min.x && min.y <= other.max.y && max.y >= other.min.y;
+  }
+
+  bool Contains(const glm::vec2 &point) const {
+    return point.x >= min.x && point.x <= max.x && point.y >= min.y && point.y <= max.y;
+  }
+};
+
+}  // namespace MEngine
@@ -11,19 +11,37 @@
 
 #pragma once
 
+#include <cstdint>
+#include <entt/entt.hpp>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/quaternion.hpp>
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <string>
 
+#include "core/asset_manager.hpp"
+#include "core/uuid.hpp"
 #include "render/gl.hpp"
 #include "render/shader.hpp"
 #include "render/texture.hpp"
+#include "scene/bounds.hpp"
 
 namespace MEngine {
 
+/**
+ * @brief Identity of an entity that survives saving and loading, unlike its entt handle.
+ *
+ */
+struct ID {
+  UUID id;
+
+  ID(UUID id) : id(id) {}
+  ID() = default;
+};
+
 struct Tag {
   std::string tag;
 
@@ -72,7 +90,7 @@ struct Camera2D {
 
   void SetPosition(const glm::vec3 &pos) { position = pos; }
 
-  void SetRotation(float rotation) { rotation = rotation; }
+  void SetRotation(float rotation) { this->rotation = rotation; }
 
   const glm::mat4 &GetViewMatrix() const { return view; }
 
@@ -98,21 +116,52 @@ struct Camera2D {
     view = glm::inverse(transform);
   }
 
+  /**
+   * @brief World space rectangle seen by the camera, enlarged to stay axis aligned when rotated.
+   *
+   */
+  Bounds2D GetViewBounds() const {
+    glm::vec2 half_extents(aspect_ratio * zoom_level, zoom_level);
+    float     angle = glm::radians(rotation);
+    float     c     = std::abs(std::cos(angle));
+    float     s     = std::abs(std::sin(angle));
+    return Bounds2D::FromCenter(glm::vec2(position),
+                                {c * half_extents.x + s * half_extents.y, s * half_extents.x + c * half_extents.y});
+  }
+
   const float &GetZoomLevel() const { return zoom_level; }
   float       &GetZoomLevel() { return zoom_level; }
   const float &GetAspectRatio() const { return aspect_ratio; }
   float       &GetAspectRatio() { return aspect_ratio; }
 
   void SetZoomLevel(float zoom_level) {
-    zoom_level = zoom_level;
+    this->zoom_level = zoom_level;
     SetProjection(-aspect_ratio * zoom_level, aspect_ratio * zoom_level, -zoom_level, zoom_level);
   }
   void SetAspectRatio(float aspect_ratio) {
-    aspect_ratio = aspect_ratio;
+    this->aspect_ratio = aspect_ratio;
     SetProjection(-aspect_ratio * zoom_level, aspect_ratio * zoom_level, -zoom_level, zoom_level);
   }
 };
 
+/**
+ * @brief translate * rotate * scale for an object that only rotates around z, written
+ * out as the 2x3 affine part of the matrix instead of composing generic 4x4 rotations.
+ *
+ * @param rotation Rotation around z in radians.
+ */
+inline glm::mat4 ComposeAffine2D(const glm::vec3 &translation, float rotation, const glm::vec3 &scale) {
+  float c = std::cos(rotation);
+  float s = std::sin(rotation);
+
+  glm::mat4 model(1.0f);
+  model[0] = glm::vec4(c * scale.x, s * scale.x, 0.0f, 0.0f);
+  model[1] = glm::vec4(-s * scale.y, c * scale.y, 0.0f, 0.0f);
+  model[2] = glm::vec4(0.0f, 0.0f, scale.z, 0.0f);
+  model[3] = glm::vec4(translation, 1.0f);
+  return model;
+}
+
 struct Transform {
   glm::vec3 translation = {0.0f, 0.0f, 0.0f};
   glm::vec3 rotation    = {0.0f, 0.0f, 0.0f};
@@ -123,91 +172,153 @@ struct Transform {
   Transform(const glm::vec3 &translation) : translation(translation) {}
 
   glm::mat4 GetTransform() const {
-    glm::mat4 rotation = glm::toMat4(glm::quat(rotation));
+    if (rotation.x == 0.0f && rotation.y == 0.0f) return ComposeAffine2D(translation, rotation.z, scale);
+
+    glm::mat4 rotation = glm::toMat4(glm::quat(this->rotation));
 
     return glm::translate(glm::mat4(1.0f), translation) * rotation * glm::scale(glm::mat4(1.0f), scale);
   }
 };
 
+/**
+ * @brief Position of an entity in the scene hierarchy. Children are kept in an
+ * intrusive doubly linked list, `depth` is 0 for roots.
+ *
+ * Scene keeps the Relationship pool sorted by depth so parents are always
+ * visited before their children.
+ *
+ */
+struct Relationship {
+  entt::entity parent       = entt::null;
+  entt::entity first_child  = entt::null;
+  entt::entity prev_sibling = entt::null;
+  entt::entity next_sibling = entt::null;
+  uint32_t     children     = 0;
+  uint32_t     depth        = 0;
+};
+
+/**
+ * @brief Cached world matrix (parent world * local), rebuilt by Scene only after the entity is tagged TransformDirty.
+ *
+ */
+struct WorldTransform {
+  glm::mat4 matrix = glm::mat4(1.0f);
+};
+
+/**
+ * @brief Tag added when a transform-carrying component is emplaced or patched.
+ * Code that changes such a component in place must go through registry.patch / Entity::Patch.
+ *
+ */
+struct TransformDirty {};
+
+/**
+ * @brief Plain data needed to draw a quad. Where it is drawn comes from the
+ * Transform (and hierarchy) of the entity through its WorldTransform.
+ *
+ */
 struct Sprite2D {
-  glm::vec3 position;
-  glm::vec3 scale;
-  glm::vec3 rotation;
-  glm::vec4 color;
+  glm::vec4 color = {1.0f, 1.0f, 1.0f, 1.0f};
+
+  // Owns one reference in the AssetManager, released by Scene with the component.
+  TextureHandle texture = AssetManager::kInvalidHandle;
 
   float tiling_factor = 1.0f;
 
-  std::shared_ptr<Texture> texture;
+  // Coarse draw order, lower layers are drawn first. At equal depth a higher layer covers a lower one,
+  // between opaque sprites at different depths the closer one is visible.
+  int layer = 0;
 
-  Sprite2D(glm::vec3 position, glm::vec3 scale, glm::vec3 rotation, glm::vec4 color, std::shared_ptr<Texture> texture)
-      : position(position), scale(scale), rotation(rotation), color(color), texture(texture) {}
+  Sprite2D(glm::vec4 color, TextureHandle texture = AssetManager::kInvalidHandle, int layer = 0)
+      : color(color), texture(texture), layer(layer) {}
 
   Sprite2D() = default;
-
-  glm::mat4 GetModelMatrix() {
-    glm::mat4 model = glm::mat4(1.0f);
-    model           = glm::translate(model, position);
-    model           = glm::rotate(model, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    model           = glm::rotate(model, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    model           = glm::rotate(model, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-    model           = glm::scale(model, scale);
-    return model;
-  }
 };
 
+/**
+ * @brief Flip-book animation over the Sprite2D texture of the same entity,
+ * the texture is split into `h_frames` x `v_frames` cells.
+ *
+ */
 struct AnimatedSprite2D {
-  glm::vec3 position;
-  glm::vec3 scale;
-  glm::vec3 rotation;
-  glm::vec4 color;
-
-  std::shared_ptr<Texture> texture;
-
-  int h_frames;
-  int v_frames;
-
-  float frame_time;
-  float current_time;
-  int   current_frame;
-
-  AnimatedSprite2D(glm::vec3 position, glm::vec3 scale, glm::vec3 rotation, glm::vec4 color,
-                   std::shared_ptr<Texture> texture, int h_frames, int v_frames, float frame_time)
-      : position(position),
-        scale(scale),
-        rotation(rotation),
-        color(color),
-        texture(texture),
-        h_frames(h_frames),
-        v_frames(v_frames),
-        frame_time(frame_time),
-        current_time(0.0f),
-        current_frame(0) {}
+  int h_frames = 1;
+  int v_frames = 1;
+
+  float frame_time    = 0.1f;
+  float current_time  = 0.0f;
+  int   current_frame = 0;
+
+  AnimatedSprite2D(int h_frames, int v_frames, float frame_time)
+      : h_frames(h_frames), v_frames(v_frames), frame_time(frame_time) {}
 
   AnimatedSprite2D() = default;
 
-  glm::mat4 GetModelMatrix() {
-    glm::mat4 model = glm::mat4(1.0f);
-    model           = glm::translate(model, position);
-    model           = glm::rotate(model, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    model           = glm::rotate(model, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    model           = glm::rotate(model, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-    model           = glm::scale(model, scale);
-    return model;
+  int GetFrameCount() const { return std::max(h_frames, 1) * std::max(v_frames, 1); }
+
+  /**
+   * @brief Texture region of `current_frame` as (u0, v0, u1, v1).
+   * Frames are numbered left to right, top to bottom.
+   *
+   */
+  glm::vec4 GetUVRect() const {
+    int   columns = std::max(h_frames, 1);
+    int   rows    = std::max(v_frames, 1);
+    float w       = 1.0f / columns;
+    float h       = 1.0f / rows;
+    int   x       = current_frame % columns;
+    int   y       = (current_frame / columns) % rows;
+    float top     = 1.0f - y * h;
+    return glm::vec4(x * w, top - h, x * w + w, top);
   }
 };
 
+/**
+ * @brief Makes an AABB or Circle on the same entity a simulated body.
+ * Colliders without a RigidBody2D are static.
+ *
+ */
+struct RigidBody2D {
+  enum class Type {
+    Static,
+    Kinematic,
+    Dynamic,
+  };
+
+  Type type = Type::Dynamic;
+
+  glm::vec2 velocity = {0.0f, 0.0f};
+
+  float mass        = 1.0f;
+  float restitution = 0.0f;
+  // Scales the world gravity, 0 for floating bodies.
+  float gravity_scale = 1.0f;
+
+  RigidBody2D() = default;
+  RigidBody2D(Type type, float mass = 1.0f) : type(type), mass(mass) {}
+
+  float GetInverseMass() const { return type == Type::Dynamic && mass > 0.0f ? 1.0f / mass : 0.0f; }
+};
+
+/**
+ * @brief Axis aligned box collider, `position` is the world space center and `scale` the full size.
+ *
+ */
 struct AABB {
-  glm::vec3 position;
-  glm::vec3 scale;
+  glm::vec3 position = {0.0f, 0.0f, 0.0f};
+  glm::vec3 scale    = {1.0f, 1.0f, 1.0f};
 
   AABB(glm::vec3 position, glm::vec3 scale) : position(position), scale(scale) {}
 
   AABB() = default;
 };
 
+/**
+ * @brief Circle collider centered at the world space `position`.
+ *
+ */
 struct Circle {
-  glm::vec3 position;
-  float     radius;
+  glm::vec3 position = {0.0f, 0.0f, 0.0f};
+  float     radius   = 0.5f;
 
   Circle(glm::vec3 position, float radius) : position(position), radius(radius) {}
 
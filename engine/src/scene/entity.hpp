@@ -31,6 +31,15 @@ class Entity {
     return registry_->get<T>(handle_);
   }
 
+  /**
+   * @brief Modify a component in place and notify its on_update listeners (e.g. transform caching).
+   *
+   */
+  template <typename T, typename... Func>
+  T &Patch(Func &&...func) {
+    return registry_->patch<T>(handle_, std::forward<Func>(func)...);
+  }
+
   template <typename T>
   bool HasComponent() {
     if (registry_ == nullptr) return false;
@@ -44,6 +53,8 @@ class Entity {
 
   entt::entity GetHandle() const { return handle_; }
 
+  entt::registry *GetRegistry() const { return registry_; }
+
   bool operator==(const Entity &other) const { return handle_ == other.handle_ && registry_ == other.registry_; }
 
   bool operator!=(const Entity &other) const { return !(*this == other); }
@@ -0,0 +1,383 @@
+#include "scene/physics_world.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/job_system.hpp"
+#include "scene/component.hpp"
+
+namespace MEngine {
+
+// Steps dropped beyond this many per Step() call so a long hitch can not snowball.
+static constexpr int kMaxStepsPerUpdate = 8;
+
+// Fraction of the penetration removed per step and the overlap tolerated without correction.
+static constexpr float kCorrectionPercent = 0.8f;
+static constexpr float kCorrectionSlop    = 0.01f;
+
+// Below this many candidate pairs the narrow-phase is not worth splitting.
+static constexpr size_t kMinPairsPerWorker = 1024;
+
+void PhysicsWorld::Bodies::clear() {
+  entity.clear();
+  shape.clear();
+  x.clear();
+  y.clear();
+  half_x.clear();
+  half_y.clear();
+  vx.clear();
+  vy.clear();
+  inv_mass.clear();
+  restitution.clear();
+  gravity_scale.clear();
+}
+
+void PhysicsWorld::Bodies::push(entt::entity e, Shape s, const glm::vec2 &position, const glm::vec2 &half_extents) {
+  entity.push_back(e);
+  shape.push_back(s);
+  x.push_back(position.x);
+  y.push_back(position.y);
+  half_x.push_back(half_extents.x);
+  half_y.push_back(half_extents.y);
+  vx.push_back(0.0f);
+  vy.push_back(0.0f);
+  inv_mass.push_back(0.0f);
+  restitution.push_back(0.0f);
+  gravity_scale.push_back(0.0f);
+}
+
+PhysicsWorld::PhysicsWorld(float fixed_timestep) : fixed_timestep_(fixed_timestep) {}
+
+void PhysicsWorld::Step(entt::registry &registry, float dt) {
+  accumulator_ += dt;
+
+  int steps = 0;
+  while (accumulator_ >= fixed_timestep_ && steps < kMaxStepsPerUpdate) {
+    StepFixed(registry);
+    accumulator_ -= fixed_timestep_;
+    steps++;
+  }
+  if (steps == kMaxStepsPerUpdate) accumulator_ = 0.0f;
+
+  stats_.steps = steps;
+}
+
+void PhysicsWorld::StepFixed(entt::registry &registry) {
+  gather(registry);
+  integrate();
+  broad_phase();
+  narrow_phase();
+  resolve();
+  write_back(registry);
+  dispatch_contacts();
+
+  stats_.bodies   = static_cast<uint32_t>(bodies_.size());
+  stats_.contacts = static_cast<uint32_t>(contacts_.size());
+}
+
+void PhysicsWorld::gather(entt::registry &registry) {
+  bodies_.clear();
+
+  auto push_body = [&](const RigidBody2D &body) {
+    bodies_.vx.back()            = body.type == RigidBody2D::Type::Static ? 0.0f : body.velocity.x;
+    bodies_.vy.back()            = body.type == RigidBody2D::Type::Static ? 0.0f : body.velocity.y;
+    bodies_.inv_mass.back()      = body.GetInverseMass();
+    bodies_.restitution.back()   = body.restitution;
+    bodies_.gravity_scale.back() = body.type == RigidBody2D::Type::Dynamic ? body.gravity_scale : 0.0f;
+  };
+
+  // Simulated bodies first, write_back() only visits this prefix. Boxes come from an owning group
+  // (declared up front by Scene) so both pools are walked in lockstep.
+  registry.group<RigidBody2D, AABB>().each([&](auto entity, auto &body, auto &aabb) {
+    bodies_.push(entity, Box, glm::vec2(aabb.position), glm::vec2(aabb.scale) * 0.5f);
+    push_body(body);
+  });
+  // An entity with both colliders is simulated as its AABB.
+  registry.view<RigidBody2D, Circle>(entt::exclude<AABB>).each([&](auto entity, auto &body, auto &circle) {
+    bodies_.push(entity, Ball, glm::vec2(circle.position), glm::vec2(circle.radius));
+    push_body(body);
+  });
+  simulated_count_ = bodies_.size();
+
+  registry.view<AABB>(entt::exclude<RigidBody2D>).each([&](auto entity, auto &aabb) {
+    bodies_.push(entity, Box, glm::vec2(aabb.position), glm::vec2(aabb.scale) * 0.5f);
+  });
+  registry.view<Circle>(entt::exclude<RigidBody2D, AABB>).each([&](auto entity, auto &circle) {
+    bodies_.push(entity, Ball, glm::vec2(circle.position), glm::vec2(circle.radius));
+  });
+}
+
+void PhysicsWorld::integrate() {
+  const float  dt = fixed_timestep_;
+  const float  gx = gravity_.x * dt;
+  const float  gy = gravity_.y * dt;
+  const size_t n  = simulated_count_;
+
+  float       *x  = bodies_.x.data();
+  float       *y  = bodies_.y.data();
+  float       *vx = bodies_.vx.data();
+  float       *vy = bodies_.vy.data();
+  const float *gs = bodies_.gravity_scale.data();
+
+  // Semi-implicit Euler. Static and kinematic bodies have a gravity scale of 0.
+  for (size_t i = 0; i < n; i++) {
+    vx[i] += gx * gs[i];
+    vy[i] += gy * gs[i];
+    x[i] += vx[i] * dt;
+    y[i] += vy[i] * dt;
+  }
+}
+
+void PhysicsWorld::broad_phase() {
+  const size_t n = bodies_.size();
+
+  sweep_.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    sweep_[i] = {bodies_.x[i] - bodies_.half_x[i], static_cast<uint32_t>(i)};
+  }
+  std::sort(sweep_.begin(), sweep_.end(), [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+
+  box_pairs_.clear();
+  ball_pairs_.clear();
+  box_ball_pairs_.clear();
+
+  for (size_t i = 0; i < n; i++) {
+    const uint32_t a     = sweep_[i].second;
+    const float    max_x = bodies_.x[a] + bodies_.half_x[a];
+
+    for (size_t j = i + 1; j < n && sweep_[j].first <= max_x; j++) {
+      const uint32_t b = sweep_[j].second;
+      // Two colliders without a rigid body never move.
+      if (a >= simulated_count_ && b >= simulated_count_) continue;
+      if (std::abs(bodies_.y[a] - bodies_.y[b]) > bodies_.half_y[a] + bodies_.half_y[b]) continue;
+
+      if (bodies_.shape[a] == Box && bodies_.shape[b] == Box) {
+        box_pairs_.push_back({a, b});
+      } else if (bodies_.shape[a] == Ball && bodies_.shape[b] == Ball) {
+        ball_pairs_.push_back({a, b});
+      } else if (bodies_.shape[a] == Box) {
+        box_ball_pairs_.push_back({a, b});
+      } else {
+        box_ball_pairs_.push_back({b, a});
+      }
+    }
+  }
+
+  stats_.candidate_pairs = static_cast<uint32_t>(box_pairs_.size() + ball_pairs_.size() + box_ball_pairs_.size());
+}
+
+void PhysicsWorld::collide_boxes(const Bodies &bodies, const Pair *pairs, size_t count,
+                                 std::vector<ContactPoint> &out) {
+  const float *x  = bodies.x.data();
+  const float *y  = bodies.y.data();
+  const float *hx = bodies.half_x.data();
+  const float *hy = bodies.half_y.data();
+
+  for (size_t k = 0; k < count; k++) {
+    const uint32_t a = pairs[k].a;
+    const uint32_t b = pairs[k].b;
+
+    float dx = x[b] - x[a];
+    float dy = y[b] - y[a];
+    float ox = hx[a] + hx[b] - std::abs(dx);
+    float oy = hy[a] + hy[b] - std::abs(dy);
+    if (ox <= 0.0f || oy <= 0.0f) continue;
+
+    // Separate along the axis of least penetration.
+    if (ox < oy) {
+      out.push_back({a, b, dx < 0.0f ? -1.0f : 1.0f, 0.0f, ox});
+    } else {
+      out.push_back({a, b, 0.0f, dy < 0.0f ? -1.0f : 1.0f, oy});
+    }
+  }
+}
+
+void PhysicsWorld::collide_balls(const Bodies &bodies, const Pair *pairs, size_t count,
+                                 std::vector<ContactPoint> &out) {
+  const float *x = bodies.x.data();
+  const float *y = bodies.y.data();
+  const float *r = bodies.half_x.data();
+
+  for (size_t k = 0; k < count; k++) {
+    const uint32_t a = pairs[k].a;
+    const uint32_t b = pairs[k].b;
+
+    float dx     = x[b] - x[a];
+    float dy     = y[b] - y[a];
+    float radius = r[a] + r[b];
+    float d2     = dx * dx + dy * dy;
+    if (d2 >= radius * radius) continue;
+
+    float d = std::sqrt(d2);
+    if (d > 1e-6f) {
+      out.push_back({a, b, dx / d, dy / d, radius - d});
+    } else {
+      out.push_back({a, b, 1.0f, 0.0f, radius});
+    }
+  }
+}
+
+void PhysicsWorld::collide_box_ball(const Bodies &bodies, const Pair *pairs, size_t count,
+                                    std::vector<ContactPoint> &out) {
+  const float *x  = bodies.x.data();
+  const float *y  = bodies.y.data();
+  const float *hx = bodies.half_x.data();
+  const float *hy = bodies.half_y.data();
+
+  for (size_t k = 0; k < count; k++) {
+    const uint32_t a = pairs[k].a;  // box
+    const uint32_t b = pairs[k].b;  // ball
+
+    float radius    = hx[b];
+    float closest_x = std::clamp(x[b], x[a] - hx[a], x[a] + hx[a]);
+    float closest_y = std::clamp(y[b], y[a] - hy[a], y[a] + hy[a]);
+    float dx        = x[b] - closest_x;
+    float dy        = y[b] - closest_y;
+    float d2        = dx * dx + dy * dy;
+    if (d2 >= radius * radius) continue;
+
+    if (d2 > 1e-12f) {
+      float d = std::sqrt(d2);
+      out.push_back({a, b, dx / d, dy / d, radius - d});
+      continue;
+    }
+
+    // The center is inside the box, push it out through the nearest face.
+    float cx = x[b] - x[a];
+    float cy = y[b] - y[a];
+    float px = hx[a] - std::abs(cx);
+    float py = hy[a] - std::abs(cy);
+    if (px < py) {
+      out.push_back({a, b, cx < 0.0f ? -1.0f : 1.0f, 0.0f, px + radius});
+    } else {
+      out.push_back({a, b, 0.0f, cy < 0.0f ? -1.0f : 1.0f, py + radius});
+    }
+  }
+}
+
+void PhysicsWorld::narrow_phase() {
+  const size_t total_pairs = stats_.candidate_pairs;
+
+  size_t workers = std::min<size_t>(worker_count_, std::max<size_t>(total_pairs / kMinPairsPerWorker, 1));
+  worker_contacts_.resize(std::max<size_t>(worker_contacts_.size(), workers));
+
+  // Worker w takes the w-th slice of every pair list, so the merged result does not depend on timing.
+  auto run = [this, workers](size_t w) {
+    auto &out = worker_contacts_[w];
+    out.clear();
+
+    auto slice = [&](const std::vector<Pair> &pairs, auto collide) {
+      size_t begin = pairs.size() * w / workers;
+      size_t end   = pairs.size() * (w + 1) / workers;
+      collide(bodies_, pairs.data() + begin, end - begin, out);
+    };
+    slice(box_pairs_, &PhysicsWorld::collide_boxes);
+    slice(ball_pairs_, &PhysicsWorld::collide_balls);
+    slice(box_ball_pairs_, &PhysicsWorld::collide_box_ball);
+  };
+
+  // One slice per job, they land on whichever threads of the job system are free.
+  JobSystem::Get().ParallelFor("NarrowPhase", workers, 1, [&run](size_t begin, size_t end) {
+    for (size_t w = begin; w < end; w++) {
+      run(w);
+    }
+  });
+
+  contacts_.clear();
+  for (size_t w = 0; w < workers; w++) {
+    contacts_.insert(contacts_.end(), worker_contacts_[w].begin(), worker_contacts_[w].end());
+  }
+}
+
+void PhysicsWorld::resolve() {
+  float       *x           = bodies_.x.data();
+  float       *y           = bodies_.y.data();
+  float       *vx          = bodies_.vx.data();
+  float       *vy          = bodies_.vy.data();
+  const float *inv_mass    = bodies_.inv_mass.data();
+  const float *restitution = bodies_.restitution.data();
+
+  for (const auto &contact : contacts_) {
+    const uint32_t a = contact.a;
+    const uint32_t b = contact.b;
+
+    float inv_mass_sum = inv_mass[a] + inv_mass[b];
+    if (inv_mass_sum <= 0.0f) continue;
+
+    float vn = (vx[b] - vx[a]) * contact.nx + (vy[b] - vy[a]) * contact.ny;
+    if (vn < 0.0f) {
+      float e = std::min(restitution[a], restitution[b]);
+      float j = -(1.0f + e) * vn / inv_mass_sum;
+      vx[a] -= j * contact.nx * inv_mass[a];
+      vy[a] -= j * contact.ny * inv_mass[a];
+      vx[b] += j * contact.nx * inv_mass[b];
+      vy[b] += j * contact.ny * inv_mass[b];
+    }
+
+    float correction = std::max(contact.penetration - kCorrectionSlop, 0.0f) / inv_mass_sum * kCorrectionPercent;
+    x[a] -= correction * contact.nx * inv_mass[a];
+    y[a] -= correction * contact.ny * inv_mass[a];
+    x[b] += correction * contact.nx * inv_mass[b];
+    y[b] += correction * contact.ny * inv_mass[b];
+  }
+}
+
+void PhysicsWorld::write_back(entt::registry &registry) {
+  for (size_t i = 0; i < simulated_count_; i++) {
+    entt::entity entity = bodies_.entity[i];
+    auto        &body   = registry.get<RigidBody2D>(entity);
+    if (body.type == RigidBody2D::Type::Static) continue;
+
+    body.velocity = glm::vec2(bodies_.vx[i], bodies_.vy[i]);
+
+    // Bodies at rest are not patched, so their transforms stay clean.
+    glm::vec2 position(bodies_.x[i], bodies_.y[i]);
+    if (bodies_.shape[i] == Box) {
+      const auto &current = registry.get<AABB>(entity).position;
+      if (current.x == position.x && current.y == position.y) continue;
+      registry.patch<AABB>(entity, [&](auto &aabb) {
+        aabb.position.x = position.x;
+        aabb.position.y = position.y;
+      });
+    } else {
+      const auto &current = registry.get<Circle>(entity).position;
+      if (current.x == position.x && current.y == position.y) continue;
+      registry.patch<Circle>(entity, [&](auto &circle) {
+        circle.position.x = position.x;
+        circle.position.y = position.y;
+      });
+    }
+
+    // The entity follows its body. The body moves in world space, a child gets it in its parent's space.
+    if (!registry.all_of<Transform>(entity)) continue;
+    const glm::mat4 *parent_world = nullptr;
+    const auto      *relationship = registry.try_get<Relationship>(entity);
+    if (relationship && relationship->parent != entt::null) {
+      if (const auto *world = registry.try_get<WorldTransform>(relationship->parent)) parent_world = &world->matrix;
+    }
+    registry.patch<Transform>(entity, [&](auto &transform) {
+      if (parent_world) {
+        float     z           = ((*parent_world) * glm::vec4(transform.translation, 1.0f)).z;
+        glm::vec4 local       = glm::inverse(*parent_world) * glm::vec4(position, z, 1.0f);
+        transform.translation = glm::vec3(local);
+      } else {
+        transform.translation.x = position.x;
+        transform.translation.y = position.y;
+      }
+    });
+  }
+}
+
+void PhysicsWorld::dispatch_contacts() {
+  if (listeners_.empty()) return;
+
+  for (const auto &point : contacts_) {
+    Contact contact{bodies_.entity[point.a], bodies_.entity[point.b], glm::vec2(point.nx, point.ny),
+                    point.penetration};
+    for (const auto &listener : listeners_) {
+      listener(contact);
+    }
+  }
+}
+
+}  // namespace MEngine
@@ -0,0 +1,176 @@
+/**
+ * @file physics_world.hpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2024-08-10
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <entt/entt.hpp>
+#include <functional>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace MEngine {
+
+/**
+ * @brief One overlap found by the narrow-phase, `normal` points from `a` to `b`.
+ *
+ */
+struct Contact {
+  entt::entity a;
+  entt::entity b;
+  glm::vec2    normal;
+  float        penetration;
+};
+
+/**
+ * @brief Fixed timestep simulation of AABB and Circle colliders.
+ *
+ * Every step gathers the colliders into flat arrays, finds candidate pairs by
+ * sweep and prune along x, tests them per shape combination in branch-light
+ * loops (optionally split into jobs on the JobSystem), resolves the contacts with
+ * one impulse pass and writes the results back to the components.
+ *
+ */
+class PhysicsWorld {
+ public:
+  using ContactListener = std::function<void(const Contact &)>;
+
+  /**
+   * @brief Counters of the last fixed step.
+   *
+   */
+  struct Statistics {
+    uint32_t bodies          = 0;
+    uint32_t candidate_pairs = 0;
+    uint32_t contacts        = 0;
+    uint32_t steps           = 0;
+  };
+
+  explicit PhysicsWorld(float fixed_timestep = 1.0f / 60.0f);
+  ~PhysicsWorld() = default;
+
+  /**
+   * @brief Advance the simulation by `dt` seconds in whole fixed steps, the
+   * remainder is carried over to the next call.
+   *
+   */
+  void Step(entt::registry &registry, float dt);
+
+  /**
+   * @brief Run exactly one fixed step.
+   *
+   */
+  void StepFixed(entt::registry &registry);
+
+  /**
+   * @brief Register a callback invoked on the calling thread for every contact after each fixed step.
+   *
+   */
+  void AddContactListener(ContactListener listener) { listeners_.push_back(std::move(listener)); }
+
+  void ClearContactListeners() { listeners_.clear(); }
+
+  void SetGravity(const glm::vec2 &gravity) { gravity_ = gravity; }
+
+  const glm::vec2 &GetGravity() const { return gravity_; }
+
+  float GetFixedTimestep() const { return fixed_timestep_; }
+
+  /**
+   * @brief Number of slices the narrow-phase is split into for the JobSystem, 1 keeps it on the calling thread.
+   *
+   */
+  void SetWorkerCount(unsigned int count) { worker_count_ = count == 0 ? 1 : count; }
+
+  unsigned int GetWorkerCount() const { return worker_count_; }
+
+  const Statistics &GetStats() const { return stats_; }
+
+ private:
+  enum Shape : uint8_t { Box = 0, Ball = 1 };
+
+  struct Pair {
+    uint32_t a;
+    uint32_t b;
+  };
+
+  struct ContactPoint {
+    uint32_t a;
+    uint32_t b;
+    float    nx;
+    float    ny;
+    float    penetration;
+  };
+
+  /**
+   * @brief Structure of arrays over every collider of the current step.
+   * For circles half_x and half_y both hold the radius.
+   *
+   */
+  struct Bodies {
+    std::vector<entt::entity> entity;
+    std::vector<uint8_t>      shape;
+    std::vector<float>        x, y;
+    std::vector<float>        half_x, half_y;
+    std::vector<float>        vx, vy;
+    std::vector<float>        inv_mass;
+    std::vector<float>        restitution;
+    std::vector<float>        gravity_scale;
+
+    void clear();
+    void push(entt::entity e, Shape s, const glm::vec2 &position, const glm::vec2 &half_extents);
+    size_t size() const { return entity.size(); }
+  };
+
+  void gather(entt::registry &registry);
+
+  void integrate();
+
+  void broad_phase();
+
+  void narrow_phase();
+
+  static void collide_boxes(const Bodies &bodies, const Pair *pairs, size_t count, std::vector<ContactPoint> &out);
+  static void collide_balls(const Bodies &bodies, const Pair *pairs, size_t count, std::vector<ContactPoint> &out);
+  static void collide_box_ball(const Bodies &bodies, const Pair *pairs, size_t count,
+                               std::vector<ContactPoint> &out);
+
+  void resolve();
+
+  void write_back(entt::registry &registry);
+
+  void dispatch_contacts();
+
+  float     fixed_timestep_;
+  float     accumulator_ = 0.0f;
+  glm::vec2 gravity_     = {0.0f, -9.81f};
+
+  unsigned int worker_count_ = 1;
+
+  Bodies bodies_;
+  // Bodies [0, simulated_count_) have a RigidBody2D, the rest are static colliders.
+  size_t simulated_count_ = 0;
+
+  std::vector<std::pair<float, uint32_t>> sweep_;
+
+  std::vector<Pair> box_pairs_;
+  std::vector<Pair> ball_pairs_;
+  std::vector<Pair> box_ball_pairs_;
+
+  std::vector<std::vector<ContactPoint>> worker_contacts_;
+  std::vector<ContactPoint>              contacts_;
+
+  std::vector<ContactListener> listeners_;
+
+  Statistics stats_;
+};
+
+}  // namespace MEngine
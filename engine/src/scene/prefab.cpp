@@ -0,0 +1,101 @@
+#include "scene/prefab.hpp"
+
+#include <type_traits>
+#include <unordered_map>
+
+#include "core/logger.hpp"
+#include "scene/scene.hpp"
+
+namespace MEngine {
+
+Prefab::~Prefab() {
+  // Every copied sprite holds a reference to its texture.
+  for (const auto &sprite : GetColumn<Sprite2D>().values) {
+    AssetManager::Get().ReleaseLater(sprite.texture);
+  }
+}
+
+std::shared_ptr<Prefab> Prefab::Create(Entity root) {
+  std::shared_ptr<Prefab> prefab(new Prefab());
+  prefab->capture(*root.GetRegistry(), root.GetHandle());
+  return prefab;
+}
+
+std::shared_ptr<Prefab> Prefab::Load(const std::string &path) {
+  auto logger = Logger::Get("Prefab");
+
+  Scene scene;
+  if (!scene.LoadScene(path)) return nullptr;
+
+  Entity root;
+  size_t roots = 0;
+  scene.ForEachEntity([&](Entity entity) {
+    if (scene.GetParent(entity) != Entity()) return;
+    root = entity;
+    roots++;
+  });
+  if (roots != 1) {
+    logger->error("{0} has {1} root entities, a prefab needs exactly one", path, roots);
+    return nullptr;
+  }
+  return Create(root);
+}
+
+void Prefab::capture(entt::registry &registry, entt::entity root) {
+  // Breadth first, so parents are numbered before their children.
+  std::vector<entt::entity>                  entities{root};
+  std::unordered_map<entt::entity, uint32_t> numbers{{root, 0}};
+  for (size_t i = 0; i < entities.size(); i++) {
+    auto *relationship = registry.try_get<Relationship>(entities[i]);
+    if (!relationship) continue;
+    for (auto child = relationship->first_child; child != entt::null;
+         child      = registry.get<Relationship>(child).next_sibling) {
+      numbers.emplace(child, static_cast<uint32_t>(entities.size()));
+      entities.push_back(child);
+    }
+  }
+
+  // Links leaving the subtree (the parent and siblings of the root) are dropped.
+  auto to_number = [&numbers](entt::entity entity) -> entt::entity {
+    auto it = numbers.find(entity);
+    if (it == numbers.end()) return entt::null;
+    return static_cast<entt::entity>(it->second);
+  };
+
+  relationships_.resize(entities.size());
+  uint32_t root_depth = 0;
+  for (size_t i = 0; i < entities.size(); i++) {
+    auto *relationship = registry.try_get<Relationship>(entities[i]);
+    if (!relationship) continue;
+    if (i == 0) root_depth = relationship->depth;
+
+    Relationship &local = relationships_[i];
+    local.parent        = to_number(relationship->parent);
+    local.first_child   = to_number(relationship->first_child);
+    local.prev_sibling  = to_number(relationship->prev_sibling);
+    local.next_sibling  = to_number(relationship->next_sibling);
+    local.children      = relationship->children;
+    local.depth         = relationship->depth - root_depth;
+  }
+
+  std::apply(
+      [&](auto &...columns) {
+        auto copy = [&](auto &column) {
+          using T = typename std::decay_t<decltype(column.values)>::value_type;
+          for (size_t i = 0; i < entities.size(); i++) {
+            if (const T *value = registry.try_get<T>(entities[i])) {
+              column.indices.push_back(static_cast<uint32_t>(i));
+              column.values.push_back(*value);
+            }
+          }
+        };
+        (copy(columns), ...);
+      },
+      columns_);
+
+  for (const auto &sprite : GetColumn<Sprite2D>().values) {
+    AssetManager::Get().Acquire(sprite.texture);
+  }
+}
+
+}  // namespace MEngine
@@ -0,0 +1,88 @@
+/**
+ * @file prefab.hpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2024-08-25
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "scene/component.hpp"
+#include "scene/entity.hpp"
+
+namespace MEngine {
+
+/**
+ * @brief A hierarchy of entities kept outside of any scene, to be stamped out by Scene::Instantiate().
+ *
+ * Entities are numbered 0 (the root) to GetEntityCount() - 1 in breadth first
+ * order. Every component type is stored as one column of (entity number, value)
+ * pairs, so an instantiation copies whole columns into the pools. Entity
+ * references inside the prefab, the Relationship links, are entity numbers
+ * stored as entt::entity and remapped to the new handles on instantiation.
+ *
+ */
+class Prefab {
+ public:
+  template <typename T>
+  struct Column {
+    std::vector<uint32_t> indices;
+    std::vector<T>        values;
+  };
+
+  ~Prefab();
+
+  /**
+   * @brief Copy `root` and all of its descendants.
+   *
+   */
+  static std::shared_ptr<Prefab> Create(Entity root);
+
+  /**
+   * @brief A scene file with a single root entity, nullptr when it can not be loaded or has several roots.
+   *
+   */
+  static std::shared_ptr<Prefab> Load(const std::string &path);
+
+  size_t GetEntityCount() const { return relationships_.size(); }
+
+  template <typename T>
+  const Column<T> &GetColumn() const {
+    return std::get<Column<T>>(columns_);
+  }
+
+  /**
+   * @brief Relationship of every entity, the links are entity numbers. The root has no parent.
+   *
+   */
+  const std::vector<Relationship> &GetRelationships() const { return relationships_; }
+
+  bool HasHierarchy() const { return relationships_.size() > 1; }
+
+ private:
+  Prefab() = default;
+
+  Prefab(const Prefab &)            = delete;
+  Prefab &operator=(const Prefab &) = delete;
+
+  void capture(entt::registry &registry, entt::entity root);
+
+  // ID is not copied, every instance gets new UUIDs.
+  std::tuple<Column<Tag>, Column<Transform>, Column<Camera2D>, Column<Sprite2D>, Column<AnimatedSprite2D>,
+             Column<RigidBody2D>, Column<AABB>, Column<Circle>>
+      columns_;
+
+  std::vector<Relationship> relationships_;
+};
+
+}  // namespace MEngine
@@ -0,0 +1,51 @@
+/**
+ * @file render_snapshot.hpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2024-08-20
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "render/texture.hpp"
+
+namespace MEngine {
+
+/**
+ * @brief Everything needed to draw one simulation tick, without touching the registry.
+ *
+ * Built by Scene::BuildSnapshot() on the simulation thread and drawn by
+ * Scene::DrawSnapshot() on the GL thread. Matrices are kept for the previous
+ * and the current tick so the GL thread can interpolate between them.
+ *
+ */
+struct RenderSnapshot {
+  struct Sprite {
+    glm::mat4     previous;
+    glm::mat4     current;
+    glm::vec4     color;
+    glm::vec4     uv_rect;
+    TextureHandle texture;
+    int           layer;
+  };
+
+  std::vector<Sprite> sprites;
+
+  glm::mat4 previous_projection_view = glm::mat4(1.0f);
+  glm::mat4 projection_view          = glm::mat4(1.0f);
+
+  uint64_t tick = 0;
+
+  // Seconds since the simulation thread started at which the tick was published.
+  double time = 0.0;
+};
+
+}  // namespace MEngine
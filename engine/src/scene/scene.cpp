@@ -1,79 +1,661 @@
 #include "scene/scene.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "core/asset_manager.hpp"
 #include "render/gl.hpp"
 #include "render/renderer.hpp"
 #include "render/shader.hpp"
 #include "render/texture.hpp"
 #include "scene/component.hpp"
+#include "scene/prefab.hpp"
+#include "scene/scene_serializer.hpp"
 
 namespace MEngine {
 
+// Below this many sprites a texture run is not worth filling streams for, the queue batches it as well.
+static constexpr size_t kMinStreamedRun = 1024;
+
 Scene::Scene() {
   logger_              = Logger::Get("Scene");
   default_camera_info_ = std::make_shared<Camera2D>(-1.6f, 1.6f, -0.9f, 0.9f, 1.0f, true);
 
-  renderer_ = std::make_shared<Renderer>();
+  // Emplacing or patching anything that places an entity in the world invalidates its cached transform.
+  // A new Sprite2D gives the entity bounds, editing one (color, texture) does not move it.
+  registry_.on_construct<Sprite2D>().connect<&Scene::on_transform_changed>(this);
+  registry_.on_construct<AABB>().connect<&Scene::on_transform_changed>(this);
+  registry_.on_update<AABB>().connect<&Scene::on_transform_changed>(this);
+  registry_.on_construct<Circle>().connect<&Scene::on_transform_changed>(this);
+  registry_.on_update<Circle>().connect<&Scene::on_transform_changed>(this);
+  registry_.on_construct<Transform>().connect<&Scene::on_transform_changed>(this);
+  registry_.on_update<Transform>().connect<&Scene::on_transform_changed>(this);
+
+  registry_.on_destroy<Sprite2D>().connect<&Scene::on_spatial_destroy>(this);
+  registry_.on_destroy<Sprite2D>().connect<&Scene::on_sprite_destroy>(this);
+  // Without its Transform the entity falls back to the identity matrix.
+  registry_.on_destroy<Transform>().connect<&Scene::on_spatial_destroy>(this);
+  registry_.on_destroy<AABB>().connect<&Scene::on_spatial_destroy>(this);
+  registry_.on_destroy<Circle>().connect<&Scene::on_spatial_destroy>(this);
+
+  registry_.on_construct<ID>().connect<&Scene::on_id_construct>(this);
+  registry_.on_destroy<ID>().connect<&Scene::on_id_destroy>(this);
+
+  // Owning groups keep these pools packed in the same order, so the render and physics
+  // loops read them without sparse set lookups. A pool can be owned by a single group.
+  registry_.group<Sprite2D, WorldTransform>();
+  registry_.group<RigidBody2D, AABB>();
+}
+
+Scene::~Scene() {
+  // Emits the destroy signals, so sprites give their texture references back.
+  registry_.clear();
+}
+
+std::shared_ptr<Renderer> Scene::GetRenderer() {
+  // Created on first use so scenes can be built and simulated without a GL context.
+  if (!renderer_) renderer_ = std::make_shared<Renderer>();
+  return renderer_;
+}
+
+void Scene::detach(entt::entity entity) {
+  auto &relationship = registry_.get<Relationship>(entity);
+  if (relationship.parent == entt::null) return;
+
+  auto &parent = registry_.get<Relationship>(relationship.parent);
+  if (parent.first_child == entity) parent.first_child = relationship.next_sibling;
+  if (relationship.prev_sibling != entt::null) {
+    registry_.get<Relationship>(relationship.prev_sibling).next_sibling = relationship.next_sibling;
+  }
+  if (relationship.next_sibling != entt::null) {
+    registry_.get<Relationship>(relationship.next_sibling).prev_sibling = relationship.prev_sibling;
+  }
+  parent.children--;
+
+  relationship.parent       = entt::null;
+  relationship.prev_sibling = entt::null;
+  relationship.next_sibling = entt::null;
+}
+
+/**
+ * @brief Append `column` once per copy, `entities` holds the copies one after the other in prefab numbering.
+ *
+ */
+template <typename T>
+static void insert_copies(entt::registry &registry, const Prefab::Column<T> &column,
+                          const std::vector<entt::entity> &entities, size_t size, size_t count) {
+  if (column.indices.empty()) return;
+
+  std::vector<entt::entity> targets;
+  std::vector<T>            values;
+  targets.reserve(column.indices.size() * count);
+  values.reserve(column.values.size() * count);
+  for (size_t copy = 0; copy < count; copy++) {
+    const entt::entity *base = entities.data() + copy * size;
+    for (uint32_t index : column.indices) {
+      targets.push_back(base[index]);
+    }
+    values.insert(values.end(), column.values.begin(), column.values.end());
+  }
+  registry.insert<T>(targets.begin(), targets.end(), values.begin());
+}
+
+std::vector<Entity> Scene::Instantiate(const Prefab &prefab, size_t count, const std::vector<Transform> &transforms) {
+  std::vector<Entity> roots;
+  const size_t        size = prefab.GetEntityCount();
+  if (size == 0 || count == 0) return roots;
+
+  std::vector<entt::entity> entities(size * count);
+  registry_.create(entities.begin(), entities.end());
+
+  // A default constructed ID draws a new UUID.
+  std::vector<ID> ids(entities.size());
+  uuid_index_.Reserve(uuid_index_.Size() + ids.size());
+  registry_.insert<ID>(entities.begin(), entities.end(), ids.begin());
+
+  // The links of the prefab are entity numbers within the same copy.
+  std::vector<Relationship> relationships;
+  relationships.reserve(entities.size());
+  for (size_t copy = 0; copy < count; copy++) {
+    const entt::entity *base  = entities.data() + copy * size;
+    auto                remap = [base](entt::entity number) -> entt::entity {
+      if (number == entt::null) return entt::null;
+      return base[entt::to_integral(number)];
+    };
+    for (const auto &local : prefab.GetRelationships()) {
+      Relationship relationship = local;
+      relationship.parent       = remap(local.parent);
+      relationship.first_child  = remap(local.first_child);
+      relationship.prev_sibling = remap(local.prev_sibling);
+      relationship.next_sibling = remap(local.next_sibling);
+      relationships.push_back(relationship);
+    }
+  }
+  registry_.insert<Relationship>(entities.begin(), entities.end(), relationships.begin());
+  // Appended entities are visited first by the pool, it has to be sorted by depth again.
+  if (prefab.HasHierarchy()) hierarchy_changed_ = true;
+
+  insert_copies(registry_, prefab.GetColumn<Tag>(), entities, size, count);
+
+  const auto &transform_column = prefab.GetColumn<Transform>();
+  if (transforms.empty()) {
+    insert_copies(registry_, transform_column, entities, size, count);
+  } else {
+    // Entity 0 is the root, it gets the transform of its copy whether or not the prefab root has one.
+    std::vector<entt::entity> targets;
+    std::vector<Transform>    values;
+    targets.reserve((transform_column.indices.size() + 1) * count);
+    values.reserve((transform_column.indices.size() + 1) * count);
+    for (size_t copy = 0; copy < count; copy++) {
+      const entt::entity *base     = entities.data() + copy * size;
+      bool                override = copy < transforms.size();
+      if (override) {
+        targets.push_back(base[0]);
+        values.push_back(transforms[copy]);
+      }
+      for (size_t i = 0; i < transform_column.indices.size(); i++) {
+        if (override && transform_column.indices[i] == 0) continue;
+        targets.push_back(base[transform_column.indices[i]]);
+        values.push_back(transform_column.values[i]);
+      }
+    }
+    registry_.insert<Transform>(targets.begin(), targets.end(), values.begin());
+  }
+
+  insert_copies(registry_, prefab.GetColumn<Camera2D>(), entities, size, count);
+  insert_copies(registry_, prefab.GetColumn<Sprite2D>(), entities, size, count);
+  for (const auto &sprite : prefab.GetColumn<Sprite2D>().values) {
+    AssetManager::Get().Acquire(sprite.texture, static_cast<uint32_t>(count));
+  }
+  insert_copies(registry_, prefab.GetColumn<AnimatedSprite2D>(), entities, size, count);
+  insert_copies(registry_, prefab.GetColumn<RigidBody2D>(), entities, size, count);
+  insert_copies(registry_, prefab.GetColumn<AABB>(), entities, size, count);
+  insert_copies(registry_, prefab.GetColumn<Circle>(), entities, size, count);
+
+  roots.reserve(count);
+  for (size_t copy = 0; copy < count; copy++) {
+    roots.emplace_back(entities[copy * size], &registry_);
+  }
+  return roots;
 }
 
-Scene::~Scene() {}
+void Scene::DestroyEntity(Entity entity) {
+  entt::entity handle = entity.GetHandle();
+  if (!registry_.valid(handle)) return;
+
+  // Collect the subtree first, destroying while walking would break the sibling links.
+  subtree_.clear();
+  subtree_.push_back(handle);
+  for (size_t i = 0; i < subtree_.size(); i++) {
+    for (auto child = registry_.get<Relationship>(subtree_[i]).first_child; child != entt::null;
+         child      = registry_.get<Relationship>(child).next_sibling) {
+      subtree_.push_back(child);
+    }
+  }
 
-void Scene::LoadScene(const std::string &path) {
-  // TODO: Implement
+  detach(handle);
+  for (auto e : subtree_) {
+    registry_.destroy(e);
+  }
 }
 
-void Scene::SaveScene(const std::string &path) {
-  // TODO: Implement
+void Scene::FlushDestroyQueue() {
+  // Indexed, destroy signals may queue more entities.
+  for (size_t i = 0; i < destroy_queue_.size(); i++) {
+    DestroyEntity(Entity(destroy_queue_[i], &registry_));
+  }
+  destroy_queue_.clear();
 }
 
-void Scene::OnUpdateEditor(Camera2D &camera) { Render(camera); }
+bool Scene::SetParent(Entity child, Entity parent) {
+  entt::entity child_handle  = child.GetHandle();
+  entt::entity parent_handle = parent.GetHandle();
+  if (child_handle == parent_handle) return false;
+
+  // Refuse to move an entity below one of its own descendants.
+  for (auto ancestor = parent_handle; ancestor != entt::null;
+       ancestor      = registry_.get<Relationship>(ancestor).parent) {
+    if (ancestor == child_handle) return false;
+  }
+
+  detach(child_handle);
+
+  auto &relationship = registry_.get<Relationship>(child_handle);
+  if (parent_handle != entt::null) {
+    auto &parent_relationship = registry_.get<Relationship>(parent_handle);
+    relationship.parent       = parent_handle;
+    relationship.next_sibling = parent_relationship.first_child;
+    if (parent_relationship.first_child != entt::null) {
+      registry_.get<Relationship>(parent_relationship.first_child).prev_sibling = child_handle;
+    }
+    parent_relationship.first_child = child_handle;
+    parent_relationship.children++;
+  }
+
+  // Depths of the whole subtree shift with it.
+  std::vector<entt::entity> stack{child_handle};
+  while (!stack.empty()) {
+    auto e = stack.back();
+    stack.pop_back();
+
+    auto &r = registry_.get<Relationship>(e);
+    r.depth = r.parent == entt::null ? 0 : registry_.get<Relationship>(r.parent).depth + 1;
+    for (auto c = r.first_child; c != entt::null; c = registry_.get<Relationship>(c).next_sibling) {
+      stack.push_back(c);
+    }
+  }
+
+  registry_.emplace_or_replace<TransformDirty>(child_handle);
+  hierarchy_changed_ = true;
+  return true;
+}
+
+Entity Scene::GetParent(Entity entity) {
+  auto parent = registry_.get<Relationship>(entity.GetHandle()).parent;
+  if (parent == entt::null) return Entity();
+  return Entity(parent, &registry_);
+}
+
+bool Scene::LoadScene(const std::string &path) {
+  SceneSerializer serializer(*this);
+  return SceneSerializer::IsBinaryFile(path) ? serializer.DeserializeBinary(path) : serializer.DeserializeText(path);
+}
+
+bool Scene::SaveScene(const std::string &path) {
+  SceneSerializer serializer(*this);
+  return SceneSerializer::IsTextPath(path) ? serializer.SerializeText(path) : serializer.SerializeBinary(path);
+}
+
+void Scene::Clear() {
+  // Emits the destroy signals, sprites give their textures back and the spatial index is emptied.
+  registry_.clear();
+  spatial_index_.Clear();
+  uuid_index_.Clear();
+
+  destroy_queue_.clear();
+  removed_entities_.clear();
+  snapshot_history_.clear();
+  hierarchy_changed_ = false;
+}
+
+void Scene::OnUpdateEditor(Camera2D &camera) {
+  FlushDestroyQueue();
+
+  GetRenderer()->BeginFrame();
+  Render(camera);
+  renderer_->EndFrame();
+}
 
 void Scene::OnUpdateSimulation(float dt, Camera2D &camera) {
-  // TODO: Update scene status
+  physics_world_.Step(registry_, dt);
+  UpdateAnimations(dt);
+  FlushDestroyQueue();
+
+  GetRenderer()->BeginFrame();
   Render(camera);
+  renderer_->EndFrame();
 }
 
 void Scene::OnUpdateRuntime(float dt, int vw, int vh) {
-  // TODO: Implement
-  bool has_primary_camera = false;
-  for (auto &entity : GetAllEntitiesWith<Camera2D>()) {
-    auto     &camera_info = entity.GetComponent<Camera2D>();
-    glm::vec3 position;
-    float     rotation;
-    if (entity.HasComponent<Sprite2D>()) {
-      auto &sprite = entity.GetComponent<Sprite2D>();
-      position     = sprite.position;
-      rotation     = sprite.rotation.z;
-    } else if (entity.HasComponent<AnimatedSprite2D>()) {
-      auto &sprite = entity.GetComponent<AnimatedSprite2D>();
-      position     = sprite.position;
-      rotation     = sprite.rotation.z;
-    } else {
-      position = glm::vec3(0.0f);
-      rotation = 0.0f;
-    }
-    if (camera_info.primary) {
-      has_primary_camera = true;
-      camera_info.SetPosition(position);
-      camera_info.SetRotation(rotation);
-      camera_info.SetProjection(-1.0f, 1.0f, -1.0f, 1.0f);
-      camera_info.SetAspectRatio((float)vw / vh);
-      Render(camera_info);
-    }
-  }
-  if (!has_primary_camera) {
-    Render(*GetDefaultCameraInfo());
+  Tick(dt);
+
+  GetRenderer()->BeginFrame();
+  Render(get_runtime_camera(vw, vh));
+  renderer_->EndFrame();
+}
+
+void Scene::Tick(float dt) {
+  physics_world_.Step(registry_, dt);
+  UpdateAnimations(dt);
+  FlushDestroyQueue();
+}
+
+Camera2D &Scene::get_runtime_camera(int vw, int vh) {
+  auto cameras = registry_.view<Camera2D>();
+  for (auto entity : cameras) {
+    auto &camera_info = cameras.get<Camera2D>(entity);
+    if (!camera_info.primary) continue;
+
+    glm::vec3 position(0.0f);
+    float     rotation = 0.0f;
+    if (auto *transform = registry_.try_get<Transform>(entity)) {
+      position = transform->translation;
+      rotation = glm::degrees(transform->rotation.z);
+    }
+    camera_info.SetPosition(position);
+    camera_info.SetRotation(rotation);
+    camera_info.SetProjection(-1.0f, 1.0f, -1.0f, 1.0f);
+    camera_info.SetAspectRatio((float)vw / vh);
+    return camera_info;
   }
+  return *GetDefaultCameraInfo();
+}
+
+void Scene::BuildSnapshot(RenderSnapshot &snapshot, int vw, int vh) {
+  stats_ = Statistics();
+
+  UpdateTransforms();
+
+  Camera2D &camera = get_runtime_camera(vw, vh);
+
+  snapshot_tick_++;
+  snapshot.tick                     = snapshot_tick_;
+  snapshot.projection_view          = camera.GetProjectionView();
+  snapshot.previous_projection_view = snapshot_tick_ == 1 ? snapshot.projection_view : snapshot_projection_view_;
+  snapshot_projection_view_         = snapshot.projection_view;
+
+  query_result_.clear();
+  spatial_index_.Query(camera.GetViewBounds(), query_result_);
+
+  auto sprites = registry_.group<Sprite2D, WorldTransform>();
+
+  snapshot.sprites.clear();
+  for (auto entity : query_result_) {
+    if (!sprites.contains(entity)) continue;
+
+    auto [sprite, world] = sprites.get<Sprite2D, WorldTransform>(entity);
+    auto *animation      = registry_.try_get<AnimatedSprite2D>(entity);
+
+    // A sprite that was not in the previous snapshot (new, or just scrolled into view) holds still for a tick.
+    auto index = static_cast<size_t>(entt::to_entity(entity));
+    if (index >= snapshot_history_.size()) snapshot_history_.resize(index + 1);
+    SnapshotHistory &history  = snapshot_history_[index];
+    bool             tracked  = history.entity == entity && history.tick + 1 == snapshot_tick_;
+    const glm::mat4 &previous = tracked ? history.matrix : world.matrix;
+
+    snapshot.sprites.push_back({previous, world.matrix, sprite.color,
+                                animation ? animation->GetUVRect() : glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),
+                                sprite.texture, sprite.layer});
+    history = {entity, snapshot_tick_, world.matrix};
+  }
+
+  stats_.visible_sprites = static_cast<uint32_t>(snapshot.sprites.size());
+  stats_.culled_sprites  = static_cast<uint32_t>(sprites.size()) - stats_.visible_sprites;
+}
+
+void Scene::DrawSnapshot(const RenderSnapshot &snapshot, float alpha) {
+  auto &asset_manager = AssetManager::Get();
+
+  GetRenderer()->BeginFrame();
+  renderer_->BeginBatch(snapshot.previous_projection_view +
+                        (snapshot.projection_view - snapshot.previous_projection_view) * alpha);
+  for (const auto &sprite : snapshot.sprites) {
+    // The simulation may have destroyed the sprite and released its texture since the snapshot was taken.
+    if (sprite.texture != AssetManager::kInvalidHandle && !asset_manager.IsValid(sprite.texture)) continue;
+
+    // Blending the matrices element-wise is exact for translation and close enough for the small
+    // rotation and scale changes of one tick.
+    renderer_->Submit(sprite.previous + (sprite.current - sprite.previous) * alpha, sprite.color, sprite.texture,
+                      sprite.uv_rect, sprite.layer);
+  }
+  renderer_->EndBatch();
+  renderer_->EndFrame();
+}
+
+void Scene::UpdateAnimations(float dt) {
+  registry_.view<AnimatedSprite2D>().each([dt](auto &sprite) {
+    if (sprite.frame_time <= 0.0f) return;
+
+    sprite.current_time += dt;
+    if (sprite.current_time < sprite.frame_time) return;
+
+    // Skip every elapsed frame at once so long hitches do not loop.
+    int steps = static_cast<int>(sprite.current_time / sprite.frame_time);
+    sprite.current_time -= steps * sprite.frame_time;
+    sprite.current_frame = (sprite.current_frame + steps) % sprite.GetFrameCount();
+  });
+}
+
+void Scene::on_transform_changed(entt::registry &registry, entt::entity entity) {
+  registry.emplace_or_replace<TransformDirty>(entity);
+}
+
+void Scene::on_spatial_destroy(entt::registry &registry, entt::entity entity) {
+  spatial_index_.Remove(entity);
+  // The entity may still have other spatial components, they are re-inserted on the next update.
+  removed_entities_.push_back(entity);
+}
+
+void Scene::on_sprite_destroy(entt::registry &registry, entt::entity entity) {
+  // Deferred to the render thread, the scene may be ticking on a simulation thread.
+  AssetManager::Get().ReleaseLater(registry.get<Sprite2D>(entity).texture);
+}
+
+void Scene::on_id_construct(entt::registry &registry, entt::entity entity) {
+  UUID uuid = registry.get<ID>(entity).id;
+  // 0 means "no UUID", such entities can not be looked up.
+  if (uuid == 0) return;
+  if (!uuid_index_.Insert(uuid, entity)) {
+    logger_->warn("UUID {0} is used by more than one entity, FindEntityByUUID returns the newest", (uint64_t)uuid);
+  }
+}
+
+void Scene::on_id_destroy(entt::registry &registry, entt::entity entity) {
+  // A duplicate UUID may point at another entity by now, leave that entry alone.
+  UUID                uuid    = registry.get<ID>(entity).id;
+  const entt::entity *indexed = uuid_index_.Find(uuid);
+  if (indexed && *indexed == entity) uuid_index_.Erase(uuid);
+}
+
+glm::mat4 Scene::get_local_matrix(entt::entity entity) {
+  if (auto *transform = registry_.try_get<Transform>(entity)) return transform->GetTransform();
+  return glm::mat4(1.0f);
+}
+
+glm::mat4 Scene::get_parent_matrix(entt::entity entity) {
+  auto *relationship = registry_.try_get<Relationship>(entity);
+  if (!relationship || relationship->parent == entt::null) return glm::mat4(1.0f);
+  auto *parent_world = registry_.try_get<WorldTransform>(relationship->parent);
+  return parent_world ? parent_world->matrix : glm::mat4(1.0f);
+}
+
+void Scene::update_world_transform(entt::entity entity) {
+  registry_.get_or_emplace<WorldTransform>(entity).matrix = get_parent_matrix(entity) * get_local_matrix(entity);
+}
+
+Bounds2D Scene::compute_bounds(entt::entity entity) {
+  Bounds2D bounds;
+  bool     empty = true;
+
+  auto merge = [&](const Bounds2D &other) {
+    bounds = empty ? other : bounds.Merged(other);
+    empty  = false;
+  };
+
+  if (registry_.all_of<Sprite2D>(entity)) {
+    merge(Bounds2D::FromQuad(registry_.get<WorldTransform>(entity).matrix));
+  }
+  if (auto *aabb = registry_.try_get<AABB>(entity)) {
+    merge(Bounds2D::FromCenter(glm::vec2(aabb->position), glm::vec2(aabb->scale) * 0.5f));
+  }
+  if (auto *circle = registry_.try_get<Circle>(entity)) {
+    merge(Bounds2D::FromCenter(glm::vec2(circle->position), glm::vec2(circle->radius)));
+  }
+  return bounds;
+}
+
+void Scene::UpdateTransforms() {
+  // The local matrix may now come from another component.
+  for (auto entity : removed_entities_) {
+    if (registry_.valid(entity)) registry_.emplace_or_replace<TransformDirty>(entity);
+  }
+  removed_entities_.clear();
+
+  if (hierarchy_changed_) {
+    // WorldTransform is owned by the sprite group and keeps the group order instead.
+    registry_.sort<Relationship>([](const auto &lhs, const auto &rhs) { return lhs.depth < rhs.depth; });
+    hierarchy_changed_ = false;
+  }
+
+  auto dirty = registry_.view<TransformDirty>();
+
+  bool propagate = false;
+  for (auto entity : dirty) {
+    auto *relationship = registry_.try_get<Relationship>(entity);
+    if (relationship && relationship->first_child != entt::null) {
+      propagate = true;
+      break;
+    }
+  }
+
+  if (propagate) {
+    // Parents precede children in the sorted pool, so every parent matrix is final when its children are visited.
+    for (auto entity : registry_.view<Relationship>()) {
+      if (!registry_.all_of<TransformDirty>(entity)) {
+        auto parent = registry_.get<Relationship>(entity).parent;
+        if (parent == entt::null || !registry_.all_of<TransformDirty>(parent)) continue;
+        registry_.emplace<TransformDirty>(entity);
+      }
+      update_world_transform(entity);
+    }
+    // Entities created outside CreateEntity have no Relationship and are always roots.
+    for (auto entity : registry_.view<TransformDirty>(entt::exclude<Relationship>)) {
+      update_world_transform(entity);
+    }
+  } else {
+    for (auto entity : dirty) {
+      update_world_transform(entity);
+    }
+  }
+
+  for (auto entity : dirty) {
+    if (!registry_.any_of<Sprite2D, AABB, Circle>(entity)) continue;
+    spatial_index_.Update(entity, compute_bounds(entity));
+  }
+  stats_.transforms_updated = static_cast<uint32_t>(dirty.size());
+
+  registry_.clear<TransformDirty>();
+}
+
+Entity Scene::PickEntity(const glm::vec2 &point) {
+  UpdateTransforms();
+
+  query_result_.clear();
+  spatial_index_.Query(point, query_result_);
+
+  entt::entity picked       = entt::null;
+  int          picked_layer = 0;
+  float        picked_depth = 0.0f;
+  for (auto entity : query_result_) {
+    int   layer = 0;
+    float depth = 0.0f;
+    if (auto *sprite = registry_.try_get<Sprite2D>(entity)) {
+      layer = sprite->layer;
+      depth = registry_.get<WorldTransform>(entity).matrix[3].z;
+    }
+    // Same rule as the depth test: the closest sprite, the higher layer among equally close ones.
+    if (picked == entt::null || depth > picked_depth || (depth == picked_depth && layer > picked_layer)) {
+      picked       = entity;
+      picked_layer = layer;
+      picked_depth = depth;
+    }
+  }
+
+  if (picked == entt::null) return Entity();
+  return Entity(picked, &registry_);
 }
 
 void Scene::Render(Camera2D &camera) {
-  for (auto &entity : GetAllEntitiesWith<Sprite2D>()) {
-    auto &sprite = entity.GetComponent<Sprite2D>();
-    renderer_->RenderSprite(sprite, camera.GetProjectionView());
+  stats_ = Statistics();
+
+  UpdateTransforms();
+
+  query_result_.clear();
+  spatial_index_.Query(camera.GetViewBounds(), query_result_);
+
+  auto sprites = registry_.group<Sprite2D, WorldTransform>();
+
+  int lowest_layer = std::numeric_limits<int>::max();
+  for (auto entity : query_result_) {
+    if (!sprites.contains(entity)) continue;
+    stats_.visible_sprites++;
+    lowest_layer = std::min(lowest_layer, sprites.get<Sprite2D>(entity).layer);
+  }
+
+  // Opaque sprites of the lowest layer come first in the sort order. Between opaque quads only those at the
+  // same depth depend on the order they are drawn in, so a large run sharing a texture can be drawn from SoA
+  // streams ahead of the queue as long as no other lowest layer quad is at the depth of any of them. The
+  // streams are filled from Transform, which is the world transform only for roots without x or y rotation.
+  stream_candidates_.clear();
+  streamed_.assign(query_result_.size(), 0);
+  bool tilted = false;
+  for (uint32_t i = 0; i < query_result_.size(); i++) {
+    entt::entity entity = query_result_[i];
+    if (!sprites.contains(entity)) continue;
+
+    const auto &sprite = sprites.get<Sprite2D>(entity);
+    if (sprite.layer != lowest_layer || Renderer::IsTranslucent(sprite.color, sprite.texture)) continue;
+
+    const auto *transform    = registry_.try_get<Transform>(entity);
+    const auto *relationship = registry_.try_get<Relationship>(entity);
+    if (transform && transform->rotation.x == 0.0f && transform->rotation.y == 0.0f &&
+        (!relationship || relationship->parent == entt::null)) {
+      if (!std::isnan(transform->translation.z)) {
+        stream_candidates_.push_back({transform->translation.z, sprite.texture, i, true});
+      }
+      continue;
+    }
+
+    // Stays queued. Tilted out of the xy plane it spans a range of depths and may tie with any sprite.
+    const glm::mat4 &world = sprites.get<WorldTransform>(entity).matrix;
+    tilted |= world[0].z != 0.0f || world[1].z != 0.0f;
+    if (!std::isnan(world[3].z)) stream_candidates_.push_back({world[3].z, sprite.texture, i, false});
+  }
+  if (tilted) stream_candidates_.clear();
+
+  // Keep the sprites whose depth is only shared by streamable ones of the same texture. Sorting is stable
+  // throughout, so sprites at one depth stay in submission order like in the queue.
+  std::stable_sort(stream_candidates_.begin(), stream_candidates_.end(),
+                   [](const auto &lhs, const auto &rhs) { return lhs.depth < rhs.depth; });
+  size_t kept = 0;
+  for (size_t first = 0, last; first < stream_candidates_.size(); first = last) {
+    const auto &head = stream_candidates_[first];
+    bool        tie  = !head.streamable;
+    for (last = first + 1; last < stream_candidates_.size() && stream_candidates_[last].depth == head.depth; last++) {
+      tie |= !stream_candidates_[last].streamable || stream_candidates_[last].texture != head.texture;
+    }
+    if (tie) continue;
+    for (size_t i = first; i < last; i++) {
+      stream_candidates_[kept++] = stream_candidates_[i];
+    }
+  }
+  stream_candidates_.resize(kept);
+  std::stable_sort(stream_candidates_.begin(), stream_candidates_.end(),
+                   [](const auto &lhs, const auto &rhs) { return lhs.texture < rhs.texture; });
+
+  GetRenderer()->BeginBatch(camera.GetProjectionView());
+  for (size_t first = 0, last = 0; first < stream_candidates_.size(); first = last) {
+    TextureHandle texture = stream_candidates_[first].texture;
+    while (last < stream_candidates_.size() && stream_candidates_[last].texture == texture) last++;
+    if (last - first < kMinStreamedRun) continue;
+
+    stream_buffer_.Clear();
+    for (size_t i = first; i < last; i++) {
+      uint32_t     index     = stream_candidates_[i].index;
+      entt::entity entity    = query_result_[index];
+      const auto  &sprite    = sprites.get<Sprite2D>(entity);
+      const auto  &transform = registry_.get<Transform>(entity);
+      auto        *animation = registry_.try_get<AnimatedSprite2D>(entity);
+      stream_buffer_.Push(transform.translation, transform.rotation.z, glm::vec2(transform.scale), sprite.color,
+                          animation ? animation->GetUVRect() : glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+      streamed_[index] = 1;
+    }
+    renderer_->SubmitBatch(stream_buffer_.GetStreams(), texture);
+    stats_.streamed_sprites += static_cast<uint32_t>(last - first);
   }
-  for (auto &entity : GetAllEntitiesWith<AnimatedSprite2D>()) {
-    auto &sprite = entity.GetComponent<AnimatedSprite2D>();
-    renderer_->RenderSprite(sprite, camera.GetProjectionView());
+
+  for (size_t i = 0; i < query_result_.size(); i++) {
+    entt::entity entity = query_result_[i];
+    if (streamed_[i] || !sprites.contains(entity)) continue;
+
+    auto [sprite, world] = sprites.get<Sprite2D, WorldTransform>(entity);
+    auto *animation      = registry_.try_get<AnimatedSprite2D>(entity);
+    renderer_->Submit(world.matrix, sprite, animation ? animation->GetUVRect() : glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
   }
+  renderer_->EndBatch();
+
+  stats_.culled_sprites = static_cast<uint32_t>(sprites.size()) - stats_.visible_sprites;
 }
 
 }  // namespace MEngine
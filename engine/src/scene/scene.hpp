@@ -11,56 +11,175 @@
 
 #pragma once
 
+#include <cstdint>
 #include <entt/entt.hpp>
 #include <memory>
 #include <vector>
 
 #include "core/logger.hpp"
+#include "core/uuid_map.hpp"
+#include "render/sprite_kernel.hpp"
+#include "render/texture.hpp"
 #include "scene/camera.hpp"
 #include "scene/entity.hpp"
+#include "scene/physics_world.hpp"
+#include "scene/render_snapshot.hpp"
+#include "scene/spatial_index.hpp"
 
 namespace MEngine {
 
+class Prefab;
 class Renderer;
 
 class Scene {
  public:
+  /**
+   * @brief Culling counters of the last Render() call.
+   *
+   */
+  struct Statistics {
+    uint32_t visible_sprites    = 0;
+    uint32_t culled_sprites     = 0;
+    uint32_t transforms_updated = 0;
+    // Visible sprites drawn from SoA streams instead of the sort queue.
+    uint32_t streamed_sprites   = 0;
+  };
+
   Scene();
   ~Scene();
 
-  Entity CreateEntity(const std::string &name = "Unnamed Entity") {
+  Entity CreateEntity(const std::string &name = "Unnamed Entity") { return CreateEntityWithUUID(UUID(), name); }
+
+  /**
+   * @brief CreateEntity() with a known identity, e.g. one read back from a file.
+   *
+   */
+  Entity CreateEntityWithUUID(UUID uuid, const std::string &name = "Unnamed Entity") {
     Entity entity = Entity(registry_.create(), &registry_);
+    entity.AddComponent<ID>(uuid);
     entity.AddComponent<Tag>(name);
-    entities_.push_back(entity);
+    entity.AddComponent<Relationship>();
     return entity;
   }
 
-  void DestroyEntity(Entity entity) {
-    // TODO
-    registry_.destroy(entity.GetHandle());
+  /**
+   * @brief Create `count` copies of `prefab` as root entities and return the root of each copy.
+   * Every component type goes into its pool with one range insert covering all copies, the
+   * Relationship links are remapped to the new entities and every entity gets a new UUID.
+   *
+   * @param transforms Transform of the root of copy i, copies past its end keep the prefab's.
+   */
+  std::vector<Entity> Instantiate(const Prefab &prefab, size_t count, const std::vector<Transform> &transforms = {});
+
+  /**
+   * @brief Destroy `entity` together with all of its descendants, in time
+   * proportional to the size of that subtree.
+   *
+   * Must not be called while iterating a view that contains the entity, use
+   * QueueDestroy() there instead.
+   */
+  void DestroyEntity(Entity entity);
+
+  /**
+   * @brief Destroy `entity` and its descendants on the next FlushDestroyQueue().
+   * Safe to call from inside Each() and contact listeners, queuing twice is harmless.
+   *
+   */
+  void QueueDestroy(Entity entity) { destroy_queue_.push_back(entity.GetHandle()); }
+
+  /**
+   * @brief Destroy every entity queued by QueueDestroy(). The OnUpdate* functions
+   * call it once the systems of the frame have run.
+   *
+   */
+  void FlushDestroyQueue();
+
+  /**
+   * @brief Move `child` under `parent`, or make it a root when `parent` is a null Entity.
+   * Requests that would create a cycle are ignored and return false.
+   *
+   */
+  bool SetParent(Entity child, Entity parent);
+
+  Entity GetParent(Entity entity);
 
-    for (auto it = entities_.begin(); it != entities_.end(); ++it) {
-      if (*it == entity) {
-        entities_.erase(it);
-        break;
-      }
+  /**
+   * @brief Call `func(Entity)` for each direct child of `entity`.
+   *
+   */
+  template <typename Func>
+  void ForEachChild(Entity entity, Func func) {
+    auto child = registry_.get<Relationship>(entity.GetHandle()).first_child;
+    while (child != entt::null) {
+      auto next = registry_.get<Relationship>(child).next_sibling;
+      func(Entity(child, &registry_));
+      child = next;
     }
   }
 
-  template <typename... Components>
-  auto GetAllEntitiesWith() {
-    auto                view = registry_.view<Components...>();
-    std::vector<Entity> entities;
-    for (auto entity : view) {
-      entities.push_back(Entity(entity, &registry_));
+  /**
+   * @brief Call `func(Entity, Components &...)` for every entity that has all of
+   * `Components`, directly over the registry view without building a list.
+   * Tag components without data cannot be requested here, use View() for them.
+   *
+   */
+  template <typename... Components, typename Func>
+  void Each(Func func) {
+    registry_.view<Components...>().each([this, &func](entt::entity entity, Components &...components) {
+      func(Entity(entity, &registry_), components...);
+    });
+  }
+
+  /**
+   * @brief Call `func(Entity)` for every entity of the scene.
+   *
+   */
+  template <typename Func>
+  void ForEachEntity(Func func) {
+    for (auto entity : registry_.view<Tag>()) {
+      func(Entity(entity, &registry_));
     }
-    return entities;
   }
 
-  std::vector<Entity> &GetAllEntities() { return entities_; }
+  /**
+   * @brief The underlying registry view, for systems that want to iterate raw handles.
+   *
+   */
+  template <typename... Components>
+  auto View() {
+    return registry_.view<Components...>();
+  }
+
+  size_t GetEntityCount() { return registry_.view<Tag>().size(); }
 
-  void LoadScene(const std::string &path);
-  void SaveScene(const std::string &path);
+  /**
+   * @brief The entity whose ID is `uuid`, or a null Entity. One probe of a flat hash table,
+   * kept up to date as entities with an ID are created and destroyed.
+   *
+   */
+  Entity FindEntityByUUID(UUID uuid) {
+    const entt::entity *entity = uuid_index_.Find(uuid);
+    return entity ? Entity(*entity, &registry_) : Entity();
+  }
+
+  /**
+   * @brief Replace every entity of the scene with the content of a scene file, binary or text, false on failure.
+   *
+   */
+  bool LoadScene(const std::string &path);
+
+  /**
+   * @brief Write every entity that has an ID to a scene file, as text when the path ends
+   * in `.scene` and binary otherwise (`.mscene`).
+   *
+   */
+  bool SaveScene(const std::string &path);
+
+  /**
+   * @brief Destroy every entity at once, without walking the hierarchy.
+   *
+   */
+  void Clear();
 
   std::shared_ptr<Camera2D> GetDefaultCameraInfo() { return default_camera_info_; }
 
@@ -70,18 +189,164 @@ class Scene {
 
   void OnUpdateRuntime(float dt, int vw, int vh);
 
+  /**
+   * @brief Advance the simulation by `dt`: physics, animations and queued destruction.
+   * Touches no GL state, so it may run on a simulation thread.
+   *
+   */
+  void Tick(float dt);
+
+  /**
+   * @brief Update the transforms and record the sprites the runtime camera sees into
+   * `snapshot`, with their matrices of the previous snapshot next to the current ones.
+   * Call after Tick(), on the same thread.
+   *
+   */
+  void BuildSnapshot(RenderSnapshot &snapshot, int vw, int vh);
+
+  /**
+   * @brief Draw `snapshot` with every matrix blended from the previous (`alpha` 0) to the
+   * current tick (`alpha` 1). Reads no components, so another thread may tick the scene meanwhile.
+   *
+   */
+  void DrawSnapshot(const RenderSnapshot &snapshot, float alpha);
+
+  /**
+   * @brief Advance the frame of every AnimatedSprite2D by `dt` seconds in one pass.
+   *
+   */
+  void UpdateAnimations(float dt);
+
+  /**
+   * @brief Submit every sprite whose world bounds overlap the view of `camera`.
+   *
+   */
   void Render(Camera2D &camera);
 
+  /**
+   * @brief Rebuild the WorldTransform and spatial index entry of every entity
+   * tagged TransformDirty, then clear the tags. Untouched entities cost nothing.
+   *
+   * When a tagged entity has children, one linear pass over the depth sorted
+   * Relationship pool carries the change down the hierarchy.
+   *
+   */
+  void UpdateTransforms();
+
+  const SpatialIndex &GetSpatialIndex() const { return spatial_index_; }
+
+  /**
+   * @brief The top-most entity under `point` in world space, or a null Entity.
+   *
+   */
+  Entity PickEntity(const glm::vec2 &point);
+
+  std::shared_ptr<Renderer> GetRenderer();
+
+  /**
+   * @brief Simulates the AABB and Circle colliders, gameplay code registers contact listeners here.
+   *
+   */
+  PhysicsWorld &GetPhysicsWorld() { return physics_world_; }
+
+  const Statistics &GetStats() const { return stats_; }
+
  private:
-  entt::registry registry_;
+  friend class SceneSerializer;
+  friend class SceneDelta;
 
-  std::vector<Entity> entities_;
+  entt::registry registry_;
 
   std::shared_ptr<spdlog::logger> logger_;
 
   std::shared_ptr<Camera2D> default_camera_info_;
 
+  void on_transform_changed(entt::registry &registry, entt::entity entity);
+
+  void on_spatial_destroy(entt::registry &registry, entt::entity entity);
+
+  void on_sprite_destroy(entt::registry &registry, entt::entity entity);
+
+  void on_id_construct(entt::registry &registry, entt::entity entity);
+
+  void on_id_destroy(entt::registry &registry, entt::entity entity);
+
+  void detach(entt::entity entity);
+
+  /**
+   * @brief Local matrix of `entity`: its Transform, else identity.
+   *
+   */
+  glm::mat4 get_local_matrix(entt::entity entity);
+
+  glm::mat4 get_parent_matrix(entt::entity entity);
+
+  /**
+   * @brief The first primary Camera2D placed by its Transform, else the default camera.
+   *
+   */
+  Camera2D &get_runtime_camera(int vw, int vh);
+
+  void update_world_transform(entt::entity entity);
+
+  /**
+   * @brief Union of the world bounds of every sprite and collider component on `entity`.
+   *
+   */
+  Bounds2D compute_bounds(entt::entity entity);
+
   std::shared_ptr<Renderer> renderer_;
+
+  SpatialIndex spatial_index_;
+
+  PhysicsWorld physics_world_;
+
+  // Entity of every ID, maintained by the ID construct and destroy signals. IDs are not patched
+  // or replaced after creation, the index would keep the old UUID.
+  UUIDMap<entt::entity> uuid_index_;
+
+  std::vector<entt::entity> query_result_;
+
+  /**
+   * @brief An opaque sprite of the lowest layer seen by Render(), `index` points into query_result_.
+   * Sprites that are not streamable stay in the queue, they only keep others at their depth from being streamed.
+   *
+   */
+  struct StreamCandidate {
+    float         depth;
+    TextureHandle texture;
+    uint32_t      index;
+    bool          streamable;
+  };
+
+  // Render() scratch: the lowest layer opaque sprites, which entries of query_result_ were streamed,
+  // and the streams of one texture run.
+  std::vector<StreamCandidate> stream_candidates_;
+  std::vector<uint8_t>         streamed_;
+  SpriteStreamBuffer           stream_buffer_;
+
+  // Entities waiting for FlushDestroyQueue(), and the subtree scratch list of DestroyEntity().
+  std::vector<entt::entity> destroy_queue_;
+  std::vector<entt::entity> subtree_;
+
+  // Entities that lost a spatial component, re-checked by the next UpdateTransforms().
+  std::vector<entt::entity> removed_entities_;
+
+  // World matrix of every sprite in the last snapshot, indexed by entity index. Only an
+  // entry written by the previous snapshot is interpolated from.
+  struct SnapshotHistory {
+    entt::entity entity = entt::null;
+    uint64_t     tick   = 0;
+    glm::mat4    matrix = glm::mat4(1.0f);
+  };
+  std::vector<SnapshotHistory> snapshot_history_;
+  glm::mat4                    snapshot_projection_view_ = glm::mat4(1.0f);
+  uint64_t                     snapshot_tick_            = 0;
+
+  // Set by SetParent, the Relationship pool is re-sorted by depth on the next update.
+  bool hierarchy_changed_ = false;
+
+  Statistics stats_;
 };
 
 }  // namespace MEngine
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "scene/scene_delta.hpp"
+
+#include "scene/scene.hpp"
+
+namespace MEngine {
+
+template <typename T>
+void SceneDelta::record_pool(entt::registry &registry) {
+  auto &pool      = get_pool<T>();
+  auto  view      = registry.view<T>();
+  pool.whole_pool = true;
+  pool.entities.reserve(view.size());
+  pool.values.reserve(view.size());
+  pool.present.reserve(view.size());
+  view.each([&pool](entt::entity entity, const T &value) { pool.Add(entity, &value); });
+}
+
+void SceneDelta::RecordScene(Scene &scene) {
+  Clear();
+  whole_scene_ = true;
+
+  // The same component types as a scene file. ID comes first, it is the set of entities.
+  entt::registry &registry = scene.registry_;
+  record_pool<ID>(registry);
+  record_pool<Tag>(registry);
+  record_pool<Relationship>(registry);
+  record_pool<Transform>(registry);
+  record_pool<Camera2D>(registry);
+  record_pool<Sprite2D>(registry);
+  record_pool<AnimatedSprite2D>(registry);
+  record_pool<RigidBody2D>(registry);
+  record_pool<AABB>(registry);
+  record_pool<Circle>(registry);
+}
+
+void SceneDelta::restore_entities(entt::registry &registry) {
+  const auto &recorded = get_pool<ID>().entities;
+
+  std::vector<entt::entity> by_index;
+  for (auto entity : recorded) {
+    size_t index = entt::to_entity(entity);
+    if (index >= by_index.size()) by_index.resize(index + 1, entt::null);
+    by_index[index] = entity;
+  }
+
+  std::vector<entt::entity> created;
+  for (auto entity : registry.view<ID>()) {
+    size_t index = entt::to_entity(entity);
+    if (index >= by_index.size() || by_index[index] != entity) created.push_back(entity);
+  }
+  // First, so the slots of the destroyed entities are free again when they are re-created.
+  registry.destroy(created.begin(), created.end());
+
+  for (auto entity : recorded) {
+    if (!registry.valid(entity)) registry.create(entity);
+  }
+}
+
+void SceneDelta::Apply(Scene &scene, SceneDelta *inverse) {
+  entt::registry           &registry = scene.registry_;
+  std::vector<entt::entity> changed;
+
+  if (whole_scene_) {
+    // Undoing a whole scene takes another copy of it, made before anything is touched.
+    if (inverse) inverse->RecordScene(scene);
+    inverse = nullptr;
+
+    restore_entities(registry);
+    scene.destroy_queue_.clear();
+  }
+
+  for (auto &pool : pools_) {
+    size_t before = changed.size();
+    pool->Apply(registry, inverse, changed);
+    if (pool->GetType() == entt::type_hash<Relationship>::value() && changed.size() > before) {
+      scene.hierarchy_changed_ = true;
+    }
+  }
+
+  // Moved, re-parented and re-created entities get their world matrix and spatial entry rebuilt.
+  for (auto entity : changed) {
+    if (registry.valid(entity)) registry.emplace_or_replace<TransformDirty>(entity);
+  }
+}
+
+}  // namespace MEngine
@@ -0,0 +1,222 @@
+/**
+ * @file scene_delta.hpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2024-08-24
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <entt/entt.hpp>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "scene/component.hpp"
+#include "scene/entity.hpp"
+
+namespace MEngine {
+
+class Scene;
+
+/**
+ * @brief Saved component values that put a scene back the way it was.
+ *
+ * Record() keeps the value, or the absence, of one component of one entity
+ * before an edit. RecordScene() copies every pool of the saved component types
+ * together with the set of entities, one pass per pool and no per-entity lookups.
+ *
+ * Apply() only writes back the values that differ from the live ones, through
+ * replace, emplace and remove so the scene refreshes its cached transforms and
+ * spatial index. The values it overwrites can be recorded into another delta,
+ * applying that one undoes the Apply().
+ *
+ * A recorded Sprite2D holds its own reference to the texture.
+ *
+ */
+class SceneDelta {
+ public:
+  SceneDelta() = default;
+
+  SceneDelta(SceneDelta &&)            = default;
+  SceneDelta &operator=(SceneDelta &&) = default;
+
+  /**
+   * @brief Remember the current `T` of `entity`, or that it has none. Only the first
+   * record of an entity and type is kept, meant for a handful of edited entities.
+   *
+   */
+  template <typename T>
+  void Record(Entity entity) {
+    get_pool<T>().Add(entity.GetHandle(), entity.GetRegistry()->try_get<T>(entity.GetHandle()));
+  }
+
+  /**
+   * @brief Remember `previous` as the `T` of `entity`, for edits that are only known once made.
+   *
+   */
+  template <typename T>
+  void Record(Entity entity, const T &previous) {
+    get_pool<T>().Add(entity.GetHandle(), &previous);
+  }
+
+  /**
+   * @brief Replace the content with every entity that has an ID and all of their saved components.
+   *
+   */
+  void RecordScene(Scene &scene);
+
+  /**
+   * @brief Make the scene match the recorded state. Entities created since RecordScene() are
+   * destroyed and destroyed ones come back under their old handle.
+   *
+   * @param inverse Receives what was overwritten, so that applying it reverts this call.
+   */
+  void Apply(Scene &scene, SceneDelta *inverse = nullptr);
+
+  bool IsEmpty() const { return pools_.empty(); }
+
+  void Clear() {
+    pools_.clear();
+    whole_scene_ = false;
+  }
+
+  template <typename T>
+  static bool IsSameValue(const T &lhs, const T &rhs) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      return std::memcmp(&lhs, &rhs, sizeof(T)) == 0;
+    } else {
+      return lhs == rhs;
+    }
+  }
+
+  static bool IsSameValue(const Tag &lhs, const Tag &rhs) { return lhs.tag == rhs.tag; }
+
+ private:
+  // Copies kept in a delta own what the component owns, by default nothing.
+  template <typename T>
+  static void retain(const T &) {}
+
+  template <typename T>
+  static void release(const T &) {}
+
+  static void retain(const Sprite2D &sprite) { AssetManager::Get().Acquire(sprite.texture); }
+
+  static void release(const Sprite2D &sprite) { AssetManager::Get().ReleaseLater(sprite.texture); }
+
+  struct Pool {
+    virtual ~Pool() = default;
+
+    virtual entt::id_type GetType() const = 0;
+
+    /**
+     * @brief Write the recorded state back, append the entities whose component changed to `changed`.
+     *
+     */
+    virtual void Apply(entt::registry &registry, SceneDelta *inverse, std::vector<entt::entity> &changed) = 0;
+  };
+
+  template <typename T>
+  struct TypedPool : Pool {
+    std::vector<entt::entity> entities;
+    std::vector<T>            values;
+    std::vector<uint8_t>      present;
+
+    // Recorded from the whole pool, entities missing here lose their component on Apply().
+    bool whole_pool = false;
+
+    ~TypedPool() override {
+      for (size_t i = 0; i < values.size(); i++) {
+        if (present[i]) release(values[i]);
+      }
+    }
+
+    entt::id_type GetType() const override { return entt::type_hash<T>::value(); }
+
+    void Add(entt::entity entity, const T *value) {
+      if (!whole_pool && std::find(entities.begin(), entities.end(), entity) != entities.end()) return;
+      entities.push_back(entity);
+      values.push_back(value ? *value : T());
+      present.push_back(value != nullptr);
+      if (value) retain(*value);
+    }
+
+    void Apply(entt::registry &registry, SceneDelta *inverse, std::vector<entt::entity> &changed) override {
+      if (whole_pool) remove_unlisted(registry, inverse, changed);
+
+      for (size_t i = 0; i < entities.size(); i++) {
+        entt::entity entity = entities[i];
+        if (!registry.valid(entity)) continue;
+
+        T *live = registry.try_get<T>(entity);
+        if (present[i]) {
+          if (live && IsSameValue(*live, values[i])) continue;
+          if (inverse) inverse->get_pool<T>().Add(entity, live);
+          retain(values[i]);
+          if (live) {
+            release(*live);
+            registry.replace<T>(entity, values[i]);
+          } else {
+            registry.emplace<T>(entity, values[i]);
+          }
+        } else {
+          if (!live) continue;
+          if (inverse) inverse->get_pool<T>().Add(entity, live);
+          registry.remove<T>(entity);
+        }
+        changed.push_back(entity);
+      }
+    }
+
+    void remove_unlisted(entt::registry &registry, SceneDelta *inverse, std::vector<entt::entity> &changed) {
+      std::vector<uint8_t> listed;
+      for (auto entity : entities) {
+        size_t index = entt::to_entity(entity);
+        if (index >= listed.size()) listed.resize(index + 1, 0);
+        listed[index] = 1;
+      }
+
+      std::vector<entt::entity> added;
+      for (auto entity : registry.view<T>()) {
+        size_t index = entt::to_entity(entity);
+        if (index >= listed.size() || !listed[index]) added.push_back(entity);
+      }
+      for (auto entity : added) {
+        if (inverse) inverse->get_pool<T>().Add(entity, &registry.get<T>(entity));
+        registry.remove<T>(entity);
+        changed.push_back(entity);
+      }
+    }
+  };
+
+  template <typename T>
+  TypedPool<T> &get_pool() {
+    for (auto &pool : pools_) {
+      if (pool->GetType() == entt::type_hash<T>::value()) return static_cast<TypedPool<T> &>(*pool);
+    }
+    pools_.push_back(std::make_unique<TypedPool<T>>());
+    return static_cast<TypedPool<T> &>(*pools_.back());
+  }
+
+  template <typename T>
+  void record_pool(entt::registry &registry);
+
+  /**
+   * @brief Destroy the entities created since RecordScene() and re-create the destroyed ones.
+   *
+   */
+  void restore_entities(entt::registry &registry);
+
+  std::vector<std::unique_ptr<Pool>> pools_;
+
+  // Recorded by RecordScene(), Apply() also restores the set of entities.
+  bool whole_scene_ = false;
+};
+
+}  // namespace MEngine
@@ -0,0 +1,1368 @@
+#include "scene/scene_serializer.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "core/asset_manager.hpp"
+#include "core/mapped_file.hpp"
+#include "scene/component.hpp"
+#include "scene/scene.hpp"
+
+namespace MEngine {
+
+// Binary scene layout, integers in the byte order of the machine that wrote it (little endian on
+// every platform we ship):
+//
+//   FileHeader
+//   ChunkHeader + payload, padded to 8 bytes      (FileHeader::chunk_count times)
+//
+// The Entities chunk comes first and holds the UUID of every entity, the other chunks
+// refer to entities by their position in it. A component chunk is the entity index of
+// every element followed by the elements themselves in their in-memory layout, with the
+// padding zeroed. The chunk header carries a hash of that layout.
+
+static constexpr char     kBinaryMagic[4] = {'M', 'E', 'S', 'C'};
+static constexpr uint32_t kBinaryVersion  = 2;
+static constexpr uint32_t kNullIndex      = 0xFFFFFFFF;
+
+enum class ChunkType : uint32_t {
+  Entities,
+  Textures,
+  Tag,
+  Relationship,
+  Transform,
+  Camera2D,
+  Sprite2D,
+  AnimatedSprite2D,
+  RigidBody2D,
+  AABB,
+  Circle,
+};
+
+struct FileHeader {
+  char     magic[4];
+  uint32_t version;
+  uint64_t entity_count;
+  uint32_t chunk_count;
+  uint32_t reserved;
+};
+
+struct ChunkHeader {
+  ChunkType type;
+  uint32_t  element_size;  // 0 for chunks with variable sized elements
+  uint64_t  count;
+  uint64_t  size;          // payload bytes without the trailing padding
+  uint32_t  layout   = 0;  // layout_hash() of plain data elements, 0 for the others
+  uint32_t  reserved = 0;
+};
+
+static_assert(sizeof(FileHeader) % 8 == 0 && sizeof(ChunkHeader) % 8 == 0, "headers keep the payloads aligned");
+static_assert(sizeof(ID) == sizeof(uint64_t) && std::is_trivially_copyable_v<ID>, "the UUID table is read as IDs");
+
+static size_t align8(size_t size) { return (size + 7) & ~size_t(7); }
+
+namespace {
+
+class BinaryWriter {
+ public:
+  explicit BinaryWriter(const std::string &path) : stream_(path, std::ios::binary | std::ios::trunc) {}
+
+  bool IsGood() const { return stream_.good(); }
+
+  void Write(const void *data, size_t size) {
+    stream_.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    written_ += size;
+  }
+
+  template <typename T>
+  void Write(const T &value) {
+    Write(&value, sizeof(T));
+  }
+
+  template <typename T>
+  void WriteArray(const std::vector<T> &values) {
+    Write(values.data(), values.size() * sizeof(T));
+  }
+
+  void Pad() {
+    static const char zeros[8] = {};
+    Write(zeros, align8(written_) - written_);
+  }
+
+  void WriteHeaderAt0(const FileHeader &header) {
+    stream_.seekp(0);
+    stream_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  }
+
+ private:
+  std::ofstream stream_;
+  size_t        written_ = 0;
+};
+
+/**
+ * @brief Bounds checked cursor over the payload of one chunk.
+ *
+ */
+class ChunkReader {
+ public:
+  ChunkReader(const uint8_t *data, size_t size) : begin_(data), cursor_(data), end_(data + size) {}
+
+  template <typename T>
+  const T *Take(size_t count) {
+    size_t bytes = count * sizeof(T);
+    if (count != 0 && bytes / count != sizeof(T)) return nullptr;
+    if (static_cast<size_t>(end_ - cursor_) < bytes) return nullptr;
+    auto *result = reinterpret_cast<const T *>(cursor_);
+    cursor_ += bytes;
+    return result;
+  }
+
+  void Align() {
+    size_t offset = align8(static_cast<size_t>(cursor_ - begin_));
+    cursor_       = begin_ + std::min(offset, static_cast<size_t>(end_ - begin_));
+  }
+
+ private:
+  const uint8_t *begin_;
+  const uint8_t *cursor_;
+  const uint8_t *end_;
+};
+
+/**
+ * @brief File index of every entity with an ID, looked up by entity index. Alive entities
+ * have distinct indices, so the version part of the handle does not need to be checked.
+ *
+ */
+class EntityIndexMap {
+ public:
+  void Add(entt::entity entity, uint32_t index) {
+    size_t slot = static_cast<size_t>(entt::to_entity(entity));
+    if (slot >= indices_.size()) indices_.resize(slot + 1, kNullIndex);
+    indices_[slot] = index;
+  }
+
+  uint32_t Get(entt::entity entity) const {
+    if (entity == entt::null) return kNullIndex;
+    size_t slot = static_cast<size_t>(entt::to_entity(entity));
+    return slot < indices_.size() ? indices_[slot] : kNullIndex;
+  }
+
+ private:
+  std::vector<uint32_t> indices_;
+};
+
+}  // namespace
+
+/**
+ * @brief Bytes of one field. Only fields are copied into a written element, the padding
+ * between them stays zero instead of leaking whatever was in memory.
+ *
+ */
+struct FieldLayout {
+  uint32_t offset;
+  uint32_t size;
+};
+
+#define MENGINE_FIELD(type, field) \
+  FieldLayout { static_cast<uint32_t>(offsetof(type, field)), static_cast<uint32_t>(sizeof(type::field)) }
+
+/**
+ * @brief Fields of every component stored as plain data. Bump kVersion when a field changes
+ * meaning without moving, moved or resized fields change the hash on their own.
+ *
+ */
+template <typename T>
+struct ComponentLayout;
+
+template <>
+struct ComponentLayout<Relationship> {
+  static constexpr uint32_t    kVersion  = 1;
+  static constexpr FieldLayout kFields[] = {
+      MENGINE_FIELD(Relationship, parent),       MENGINE_FIELD(Relationship, first_child),
+      MENGINE_FIELD(Relationship, prev_sibling), MENGINE_FIELD(Relationship, next_sibling),
+      MENGINE_FIELD(Relationship, children),     MENGINE_FIELD(Relationship, depth),
+  };
+};
+
+template <>
+struct ComponentLayout<Transform> {
+  static constexpr uint32_t    kVersion  = 1;
+  static constexpr FieldLayout kFields[] = {
+      MENGINE_FIELD(Transform, translation),
+      MENGINE_FIELD(Transform, rotation),
+      MENGINE_FIELD(Transform, scale),
+  };
+};
+
+template <>
+struct ComponentLayout<Camera2D> {
+  static constexpr uint32_t    kVersion  = 1;
+  static constexpr FieldLayout kFields[] = {
+      MENGINE_FIELD(Camera2D, position),   MENGINE_FIELD(Camera2D, rotation), MENGINE_FIELD(Camera2D, aspect_ratio),
+      MENGINE_FIELD(Camera2D, zoom_level), MENGINE_FIELD(Camera2D, primary),  MENGINE_FIELD(Camera2D, view),
+      MENGINE_FIELD(Camera2D, projection),
+  };
+};
+
+template <>
+struct ComponentLayout<Sprite2D> {
+  static constexpr uint32_t    kVersion  = 1;
+  static constexpr FieldLayout kFields[] = {
+      MENGINE_FIELD(Sprite2D, color),
+      MENGINE_FIELD(Sprite2D, texture),
+      MENGINE_FIELD(Sprite2D, tiling_factor),
+      MENGINE_FIELD(Sprite2D, layer),
+  };
+};
+
+template <>
+struct ComponentLayout<AnimatedSprite2D> {
+  static constexpr uint32_t    kVersion  = 1;
+  static constexpr FieldLayout kFields[] = {
+      MENGINE_FIELD(AnimatedSprite2D, h_frames),     MENGINE_FIELD(AnimatedSprite2D, v_frames),
+      MENGINE_FIELD(AnimatedSprite2D, frame_time),   MENGINE_FIELD(AnimatedSprite2D, current_time),
+      MENGINE_FIELD(AnimatedSprite2D, current_frame),
+  };
+};
+
+template <>
+struct ComponentLayout<RigidBody2D> {
+  static constexpr uint32_t    kVersion  = 1;
+  static constexpr FieldLayout kFields[] = {
+      MENGINE_FIELD(RigidBody2D, type),        MENGINE_FIELD(RigidBody2D, velocity),
+      MENGINE_FIELD(RigidBody2D, mass),        MENGINE_FIELD(RigidBody2D, restitution),
+      MENGINE_FIELD(RigidBody2D, gravity_scale),
+  };
+};
+
+template <>
+struct ComponentLayout<AABB> {
+  static constexpr uint32_t    kVersion  = 1;
+  static constexpr FieldLayout kFields[] = {
+      MENGINE_FIELD(AABB, position),
+      MENGINE_FIELD(AABB, scale),
+  };
+};
+
+template <>
+struct ComponentLayout<Circle> {
+  static constexpr uint32_t    kVersion  = 1;
+  static constexpr FieldLayout kFields[] = {
+      MENGINE_FIELD(Circle, position),
+      MENGINE_FIELD(Circle, radius),
+  };
+};
+
+#undef MENGINE_FIELD
+
+/**
+ * @brief FNV-1a over the version, size and field layout of `T`. A file written by a build
+ * where they differ is skipped chunk by chunk, even when the element size happens to match.
+ *
+ */
+template <typename T>
+static constexpr uint32_t layout_hash() {
+  uint32_t hash = 2166136261u;
+  auto     mix  = [&hash](uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+      hash ^= (value >> shift) & 0xffu;
+      hash *= 16777619u;
+    }
+  };
+  mix(ComponentLayout<T>::kVersion);
+  mix(static_cast<uint32_t>(sizeof(T)));
+  for (const auto &field : ComponentLayout<T>::kFields) {
+    mix(field.offset);
+    mix(field.size);
+  }
+  return hash;
+}
+
+/**
+ * @brief Copy the fields of `component` into `out`, which is zeroed and sizeof(T) bytes long.
+ *
+ */
+template <typename T>
+static void store_fields(const T &component, uint8_t *out) {
+  const auto *bytes = reinterpret_cast<const uint8_t *>(&component);
+  for (const auto &field : ComponentLayout<T>::kFields) {
+    std::memcpy(out + field.offset, bytes + field.offset, field.size);
+  }
+}
+
+/**
+ * @brief Write the pool of `T` as one chunk, `fix` rewrites the copy of each element
+ * (handles into file indices). Returns the number of chunks written.
+ *
+ */
+template <typename T, typename Fix>
+static uint32_t write_pool(BinaryWriter &writer, entt::registry &registry, ChunkType type,
+                           const EntityIndexMap &index_map, Fix fix) {
+  static_assert(std::is_trivially_copyable_v<T> && alignof(T) <= 8, "pools are written as raw memory");
+
+  std::vector<uint32_t> indices;
+  std::vector<uint8_t>  elements;
+
+  auto view = registry.view<T>();
+  indices.reserve(view.size());
+  elements.reserve(view.size() * sizeof(T));
+  view.each([&](entt::entity entity, T &component) {
+    uint32_t index = index_map.Get(entity);
+    if (index == kNullIndex) return;
+    T copy = component;
+    fix(copy);
+    indices.push_back(index);
+    elements.resize(elements.size() + sizeof(T));
+    store_fields(copy, elements.data() + elements.size() - sizeof(T));
+  });
+  if (indices.empty()) return 0;
+
+  size_t size = align8(indices.size() * sizeof(uint32_t)) + elements.size();
+  writer.Write(ChunkHeader{type, sizeof(T), indices.size(), size, layout_hash<T>()});
+  writer.WriteArray(indices);
+  writer.Pad();
+  writer.WriteArray(elements);
+  writer.Pad();
+  return 1;
+}
+
+template <typename T>
+static uint32_t write_pool(BinaryWriter &writer, entt::registry &registry, ChunkType type,
+                           const EntityIndexMap &index_map) {
+  return write_pool<T>(writer, registry, type, index_map, [](T &) {});
+}
+
+/**
+ * @brief Strings as a length table followed by the characters, shared by the Tag and Textures chunks.
+ *
+ */
+static void write_strings(BinaryWriter &writer, const std::vector<const std::string *> &strings) {
+  std::vector<uint32_t> lengths;
+  lengths.reserve(strings.size());
+  for (auto *string : strings) {
+    lengths.push_back(static_cast<uint32_t>(string->size()));
+  }
+  writer.WriteArray(lengths);
+  writer.Pad();
+  for (auto *string : strings) {
+    writer.Write(string->data(), string->size());
+  }
+  writer.Pad();
+}
+
+static size_t strings_size(const std::vector<const std::string *> &strings) {
+  size_t size = align8(strings.size() * sizeof(uint32_t));
+  for (auto *string : strings) {
+    size += string->size();
+  }
+  return size;
+}
+
+/**
+ * @brief Read what write_strings() wrote, `func(index, data, length)` is called per string.
+ *
+ */
+template <typename Func>
+static bool read_strings(ChunkReader &chunk, size_t count, Func func) {
+  const uint32_t *lengths = chunk.Take<uint32_t>(count);
+  if (!lengths) return false;
+  chunk.Align();
+  for (size_t i = 0; i < count; i++) {
+    const char *data = chunk.Take<char>(lengths[i]);
+    if (!data) return false;
+    func(i, data, lengths[i]);
+  }
+  return true;
+}
+
+/**
+ * @brief Entity handles of the element indices at the start of a component chunk.
+ *
+ */
+static bool read_targets(ChunkReader &chunk, size_t count, const std::vector<entt::entity> &entities,
+                         std::vector<entt::entity> &targets) {
+  const uint32_t *indices = chunk.Take<uint32_t>(count);
+  if (!indices) return false;
+  chunk.Align();
+
+  targets.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    if (indices[i] >= entities.size()) return false;
+    targets[i] = entities[indices[i]];
+  }
+  return true;
+}
+
+/**
+ * @brief Construct the whole pool of `T` with one range insert from the mapped elements.
+ *
+ */
+template <typename T>
+static bool read_pool(entt::registry &registry, ChunkReader &chunk, size_t count,
+                      const std::vector<entt::entity> &entities, std::vector<entt::entity> &targets) {
+  static_assert(std::is_trivially_copyable_v<T> && alignof(T) <= 8, "pools are read as raw memory");
+
+  if (!read_targets(chunk, count, entities, targets)) return false;
+  const T *values = chunk.Take<T>(count);
+  if (!values) return false;
+
+  registry.insert<T>(targets.begin(), targets.end(), values);
+  return true;
+}
+
+SceneSerializer::SceneSerializer(Scene &scene) : scene_(scene) { logger_ = Logger::Get("SceneSerializer"); }
+
+TextureHandle SceneSerializer::get_texture(const std::string &path, UUID uuid) const {
+  auto &asset_manager = AssetManager::Get();
+  return texture_mode_ == TextureMode::PathOnly ? asset_manager.ReferenceTexture(path, uuid)
+                                                : asset_manager.LoadTexture(path, uuid);
+}
+
+bool SceneSerializer::SerializeBinary(const std::string &path) {
+  entt::registry &registry = scene_.registry_;
+
+  BinaryWriter writer(path);
+  if (!writer.IsGood()) {
+    logger_->error("Failed to open {0} for writing", path);
+    return false;
+  }
+
+  FileHeader header{};
+  std::memcpy(header.magic, kBinaryMagic, sizeof(kBinaryMagic));
+  header.version = kBinaryVersion;
+  writer.Write(header);
+
+  // Entities, in the order of the ID pool.
+  EntityIndexMap        index_map;
+  std::vector<uint64_t> uuids;
+  auto                  ids = registry.view<ID>();
+  uuids.reserve(ids.size());
+  ids.each([&](entt::entity entity, ID &id) {
+    index_map.Add(entity, static_cast<uint32_t>(uuids.size()));
+    uuids.push_back(id.id);
+  });
+  writer.Write(ChunkHeader{ChunkType::Entities, sizeof(uint64_t), uuids.size(), uuids.size() * sizeof(uint64_t)});
+  writer.WriteArray(uuids);
+  writer.Pad();
+  header.entity_count = uuids.size();
+  header.chunk_count  = 1;
+
+  // Textures before the sprites that refer to them by position (plus one, 0 is no texture).
+  auto                                        &asset_manager = AssetManager::Get();
+  std::unordered_map<TextureHandle, uint32_t> texture_numbers;
+  std::vector<uint64_t>                       texture_uuids;
+  std::vector<const std::string *>            texture_paths;
+  registry.view<Sprite2D>().each([&](entt::entity entity, Sprite2D &sprite) {
+    if (index_map.Get(entity) == kNullIndex || texture_numbers.count(sprite.texture)) return;
+    const std::string &texture_path = asset_manager.GetPath(sprite.texture);
+    if (texture_path.empty()) return;  // invalid, or created in code and not backed by a file
+    texture_numbers[sprite.texture] = static_cast<uint32_t>(texture_paths.size() + 1);
+    texture_uuids.push_back(asset_manager.GetUUID(sprite.texture));
+    texture_paths.push_back(&texture_path);
+  });
+  if (!texture_paths.empty()) {
+    writer.Write(ChunkHeader{ChunkType::Textures, 0, texture_paths.size(),
+                             texture_uuids.size() * sizeof(uint64_t) + strings_size(texture_paths)});
+    writer.WriteArray(texture_uuids);
+    write_strings(writer, texture_paths);
+    header.chunk_count++;
+  }
+
+  // Tags are the only strings per entity, written as a length table and the characters.
+  {
+    std::vector<uint32_t>            indices;
+    std::vector<const std::string *> names;
+    registry.view<Tag>().each([&](entt::entity entity, Tag &tag) {
+      uint32_t index = index_map.Get(entity);
+      if (index == kNullIndex) return;
+      indices.push_back(index);
+      names.push_back(&tag.tag);
+    });
+    if (!indices.empty()) {
+      size_t size = align8(indices.size() * sizeof(uint32_t)) + strings_size(names);
+      writer.Write(ChunkHeader{ChunkType::Tag, 0, indices.size(), size});
+      writer.WriteArray(indices);
+      writer.Pad();
+      write_strings(writer, names);
+      header.chunk_count++;
+    }
+  }
+
+  // Handles only mean something in this registry, links are stored as entity indices.
+  auto store_links = [&index_map](Relationship &relationship) {
+    for (auto *link : {&relationship.parent, &relationship.first_child, &relationship.prev_sibling,
+                       &relationship.next_sibling}) {
+      *link = static_cast<entt::entity>(index_map.Get(*link));
+    }
+  };
+  auto store_texture = [&texture_numbers](Sprite2D &sprite) {
+    auto it        = texture_numbers.find(sprite.texture);
+    sprite.texture = it == texture_numbers.end() ? 0 : it->second;
+  };
+
+  header.chunk_count += write_pool<Relationship>(writer, registry, ChunkType::Relationship, index_map, store_links);
+  header.chunk_count += write_pool<Transform>(writer, registry, ChunkType::Transform, index_map);
+  header.chunk_count += write_pool<Camera2D>(writer, registry, ChunkType::Camera2D, index_map);
+  header.chunk_count += write_pool<Sprite2D>(writer, registry, ChunkType::Sprite2D, index_map, store_texture);
+  header.chunk_count += write_pool<AnimatedSprite2D>(writer, registry, ChunkType::AnimatedSprite2D, index_map);
+  header.chunk_count += write_pool<RigidBody2D>(writer, registry, ChunkType::RigidBody2D, index_map);
+  header.chunk_count += write_pool<AABB>(writer, registry, ChunkType::AABB, index_map);
+  header.chunk_count += write_pool<Circle>(writer, registry, ChunkType::Circle, index_map);
+
+  writer.WriteHeaderAt0(header);
+  if (!writer.IsGood()) {
+    logger_->error("Failed to write {0}", path);
+    return false;
+  }
+  return true;
+}
+
+bool SceneSerializer::DeserializeBinary(const std::string &path) {
+  using Clock = std::chrono::steady_clock;
+  auto start  = Clock::now();
+
+  MappedFile file;
+  if (!file.Open(path)) {
+    logger_->error("Failed to open {0}", path);
+    return false;
+  }
+
+  ChunkReader reader(file.GetData(), file.GetSize());
+  const auto *header = reader.Take<FileHeader>(1);
+  if (!header || std::memcmp(header->magic, kBinaryMagic, sizeof(kBinaryMagic)) != 0) {
+    logger_->error("{0} is not a binary scene", path);
+    return false;
+  }
+  if (header->version != kBinaryVersion) {
+    logger_->error("{0} has scene format version {1}, expected {2}", path, header->version, kBinaryVersion);
+    return false;
+  }
+
+  scene_.Clear();
+  entt::registry &registry = scene_.registry_;
+
+  auto                      &asset_manager = AssetManager::Get();
+  std::vector<entt::entity>  entities;
+  std::vector<entt::entity>  targets;
+  std::vector<TextureHandle> textures;
+
+  bool   ok        = true;
+  size_t tags      = 0;
+  size_t relations = 0;
+  for (uint32_t i = 0; ok && i < header->chunk_count; i++) {
+    const auto *chunk_header = reader.Take<ChunkHeader>(1);
+    const auto *payload      = chunk_header ? reader.Take<uint8_t>(chunk_header->size) : nullptr;
+    if (!payload) {
+      ok = false;
+      break;
+    }
+    reader.Align();
+
+    ChunkReader chunk(payload, chunk_header->size);
+    size_t      count = chunk_header->count;
+
+    // Plain data chunks whose element layout changed were written by a different build, skip them.
+    auto matches = [&](size_t element_size, uint32_t layout) {
+      if (chunk_header->element_size == element_size && chunk_header->layout == layout) return true;
+      logger_->warn("Skipping chunk {0} of {1}: element size {2} and layout {3:08x}, expected {4} and {5:08x}",
+                    static_cast<uint32_t>(chunk_header->type), path, chunk_header->element_size,
+                    chunk_header->layout, element_size, layout);
+      return false;
+    };
+
+    switch (chunk_header->type) {
+      case ChunkType::Entities: {
+        const auto *ids = chunk.Take<ID>(count);
+        if (!ids || !entities.empty() || chunk_header->element_size != sizeof(ID)) {
+          ok = false;
+          break;
+        }
+        entities.resize(count);
+        registry.create(entities.begin(), entities.end());
+        // The construct signal indexes every UUID, grow the index once up front.
+        scene_.uuid_index_.Reserve(count);
+        registry.insert<ID>(entities.begin(), entities.end(), ids);
+        break;
+      }
+      case ChunkType::Textures: {
+        const uint64_t *uuids = chunk.Take<uint64_t>(count);
+        auto            load  = [&](size_t index, const char *data, uint32_t length) {
+          textures.push_back(get_texture(std::string(data, length), UUID(uuids[index])));
+        };
+        ok = uuids && read_strings(chunk, count, load);
+        break;
+      }
+      case ChunkType::Tag: {
+        // The indices bound `count` by the payload size before anything is allocated from it.
+        ok = read_targets(chunk, count, entities, targets);
+        if (!ok) break;
+
+        std::vector<Tag> names(count);
+        auto             assign = [&names](size_t index, const char *data, uint32_t length) {
+          names[index].tag.assign(data, length);
+        };
+        ok = read_strings(chunk, count, assign);
+        if (!ok) break;
+        registry.insert<Tag>(targets.begin(), targets.end(), names.begin());
+        tags = count;
+        break;
+      }
+      case ChunkType::Relationship: {
+        if (!matches(sizeof(Relationship), layout_hash<Relationship>())) break;
+        ok                         = read_targets(chunk, count, entities, targets);
+        const Relationship *values = ok ? chunk.Take<Relationship>(count) : nullptr;
+        if (!values) {
+          ok = false;
+          break;
+        }
+
+        // Links were written as entity indices.
+        std::vector<Relationship> relationships(values, values + count);
+        for (auto &relationship : relationships) {
+          for (auto *link : {&relationship.parent, &relationship.first_child, &relationship.prev_sibling,
+                             &relationship.next_sibling}) {
+            auto index = entt::to_integral(*link);
+            *link      = index < entities.size() ? entities[index] : entt::null;
+          }
+        }
+        registry.insert<Relationship>(targets.begin(), targets.end(), relationships.begin());
+        relations = count;
+        break;
+      }
+      case ChunkType::Sprite2D: {
+        if (!matches(sizeof(Sprite2D), layout_hash<Sprite2D>())) break;
+        ok                     = read_targets(chunk, count, entities, targets);
+        const Sprite2D *values = ok ? chunk.Take<Sprite2D>(count) : nullptr;
+        if (!values) {
+          ok = false;
+          break;
+        }
+
+        // Texture numbers become handles, every sprite owns one reference.
+        std::vector<Sprite2D> sprites(values, values + count);
+        for (auto &sprite : sprites) {
+          uint32_t number = sprite.texture;
+          sprite.texture  = number > 0 && number <= textures.size() ? textures[number - 1] : 0;
+          asset_manager.Acquire(sprite.texture);
+        }
+        registry.insert<Sprite2D>(targets.begin(), targets.end(), sprites.begin());
+        break;
+      }
+      case ChunkType::Transform:
+        if (matches(sizeof(Transform), layout_hash<Transform>())) {
+          ok = read_pool<Transform>(registry, chunk, count, entities, targets);
+        }
+        break;
+      case ChunkType::Camera2D:
+        if (matches(sizeof(Camera2D), layout_hash<Camera2D>())) {
+          ok = read_pool<Camera2D>(registry, chunk, count, entities, targets);
+        }
+        break;
+      case ChunkType::AnimatedSprite2D:
+        if (matches(sizeof(AnimatedSprite2D), layout_hash<AnimatedSprite2D>())) {
+          ok = read_pool<AnimatedSprite2D>(registry, chunk, count, entities, targets);
+        }
+        break;
+      case ChunkType::RigidBody2D:
+        if (matches(sizeof(RigidBody2D), layout_hash<RigidBody2D>())) {
+          ok = read_pool<RigidBody2D>(registry, chunk, count, entities, targets);
+        }
+        break;
+      case ChunkType::AABB:
+        if (matches(sizeof(AABB), layout_hash<AABB>())) {
+          ok = read_pool<AABB>(registry, chunk, count, entities, targets);
+        }
+        break;
+      case ChunkType::Circle:
+        if (matches(sizeof(Circle), layout_hash<Circle>())) {
+          ok = read_pool<Circle>(registry, chunk, count, entities, targets);
+        }
+        break;
+      default:
+        // Written by a newer build, the rest of the file is still readable.
+        logger_->warn("Skipping unknown chunk {0} of {1}", static_cast<uint32_t>(chunk_header->type), path);
+        break;
+    }
+  }
+
+  // The sprites hold their own references now.
+  for (auto texture : textures) {
+    asset_manager.Release(texture);
+  }
+
+  if (!ok) {
+    logger_->error("{0} is truncated or corrupt", path);
+    scene_.Clear();
+    return false;
+  }
+
+  // Every entity of a scene has a Tag and a Relationship, older files may lack some.
+  if (tags != entities.size() || relations != entities.size()) {
+    for (auto entity : entities) {
+      registry.get_or_emplace<Tag>(entity);
+      registry.get_or_emplace<Relationship>(entity);
+    }
+  }
+  scene_.hierarchy_changed_ = true;
+
+  logger_->info("Loaded {0} entities from {1} in {2:.1f} ms", entities.size(), path,
+                std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+  return true;
+}
+
+// Text scene layout, one statement per line, '#' starts a comment:
+//
+//   scene 1
+//   entity <uuid>
+//     tag "Player"
+//     parent <uuid>
+//     transform translation 0 1 0 rotation 0 0 0 scale 1 1 1
+//     sprite color 1 1 1 1 texture "res/player.png" <uuid> tiling 1 layer 0
+//   end
+//
+// Components are written with all of their fields, fields may be left out or
+// reordered when written by hand. Floats use the shortest form that reads back
+// to the same value, so a save without changes gives the same file.
+
+static constexpr uint32_t kTextVersion = 1;
+
+namespace {
+
+class TextWriter {
+ public:
+  explicit TextWriter(const std::string &path) : stream_(path, std::ios::binary | std::ios::trunc) {
+    buffer_.reserve(kFlushSize + 1024);
+  }
+
+  ~TextWriter() { Flush(); }
+
+  bool IsGood() const { return stream_.good(); }
+
+  TextWriter &Word(std::string_view word) {
+    separate();
+    buffer_.append(word);
+    return *this;
+  }
+
+  TextWriter &Float(float value) {
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return Word(std::string_view(buffer, result.ptr - buffer));
+  }
+
+  TextWriter &Vec(const float *values, int count) {
+    for (int i = 0; i < count; i++) {
+      Float(values[i]);
+    }
+    return *this;
+  }
+
+  template <typename Integer>
+  TextWriter &Int(Integer value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return Word(std::string_view(buffer, result.ptr - buffer));
+  }
+
+  TextWriter &String(std::string_view value) {
+    separate();
+    buffer_ += '"';
+    for (char c : value) {
+      if (c == '"' || c == '\\') buffer_ += '\\';
+      if (c == '\n') {
+        buffer_ += "\\n";
+        continue;
+      }
+      buffer_ += c;
+    }
+    buffer_ += '"';
+    return *this;
+  }
+
+  TextWriter &Indent() {
+    buffer_ += "  ";
+    line_start_ = true;
+    return *this;
+  }
+
+  void EndLine() {
+    buffer_ += '\n';
+    line_start_ = true;
+    if (buffer_.size() >= kFlushSize) Flush();
+  }
+
+  void Flush() {
+    stream_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+  }
+
+ private:
+  static constexpr size_t kFlushSize = 1 << 20;
+
+  void separate() {
+    if (!line_start_) buffer_ += ' ';
+    line_start_ = false;
+  }
+
+  std::ofstream stream_;
+  std::string   buffer_;
+  bool          line_start_ = true;
+};
+
+/**
+ * @brief Single pass over the text, tokens point into it. Only strings with escapes
+ * are copied, into one buffer reused for every such string.
+ *
+ */
+class Tokenizer {
+ public:
+  enum class Kind {
+    Word,
+    String,
+    EndOfLine,
+    EndOfFile,
+    Error,
+  };
+
+  struct Token {
+    Kind             kind;
+    std::string_view text;
+  };
+
+  Tokenizer(const char *begin, const char *end) : cursor_(begin), end_(end) {}
+
+  Token Next() {
+    while (cursor_ < end_) {
+      char c = *cursor_;
+      if (c == ' ' || c == '\t' || c == '\r') {
+        cursor_++;
+      } else if (c == '#') {
+        while (cursor_ < end_ && *cursor_ != '\n') cursor_++;
+      } else {
+        break;
+      }
+    }
+    if (cursor_ == end_) return {Kind::EndOfFile, {}};
+
+    const char *start = cursor_;
+    if (*cursor_ == '\n') {
+      cursor_++;
+      line_++;
+      return {Kind::EndOfLine, std::string_view(start, 1)};
+    }
+    if (*cursor_ == '"') return string();
+
+    while (cursor_ < end_ && !is_separator(*cursor_)) cursor_++;
+    return {Kind::Word, std::string_view(start, cursor_ - start)};
+  }
+
+  size_t GetLine() const { return line_; }
+
+ private:
+  static bool is_separator(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '"' || c == '#'; }
+
+  Token string() {
+    const char *start = ++cursor_;
+    while (cursor_ < end_ && *cursor_ != '"' && *cursor_ != '\\' && *cursor_ != '\n') cursor_++;
+    if (cursor_ < end_ && *cursor_ == '"') {
+      return {Kind::String, std::string_view(start, cursor_++ - start)};
+    }
+
+    // Escapes, fall back to the copy.
+    escaped_.assign(start, cursor_);
+    while (cursor_ < end_ && *cursor_ != '"' && *cursor_ != '\n') {
+      char c = *cursor_++;
+      if (c == '\\' && cursor_ < end_) {
+        c = *cursor_++;
+        if (c == 'n') c = '\n';
+      }
+      escaped_ += c;
+    }
+    if (cursor_ == end_ || *cursor_ != '"') return {Kind::Error, "unterminated string"};
+    cursor_++;
+    return {Kind::String, escaped_};
+  }
+
+  const char *cursor_;
+  const char *end_;
+  size_t      line_ = 1;
+  std::string escaped_;
+};
+
+/**
+ * @brief Statement level reading on top of the tokenizer. Every Read* returns false on
+ * a malformed value and leaves the reason in `error`.
+ *
+ */
+class TextReader {
+ public:
+  TextReader(const char *begin, const char *end) : tokenizer_(begin, end) {}
+
+  Tokenizer::Token Next() { return tokenizer_.Next(); }
+
+  bool ReadFloat(float &value) {
+    auto token = tokenizer_.Next();
+    if (token.kind == Tokenizer::Kind::Word) {
+      auto result = std::from_chars(token.text.data(), token.text.data() + token.text.size(), value);
+      if (result.ec == std::errc() && result.ptr == token.text.data() + token.text.size()) return true;
+    }
+    return Fail("expected a number");
+  }
+
+  bool ReadFloats(float *values, int count) {
+    for (int i = 0; i < count; i++) {
+      if (!ReadFloat(values[i])) return false;
+    }
+    return true;
+  }
+
+  template <typename Integer>
+  bool ReadInt(Integer &value) {
+    auto token = tokenizer_.Next();
+    if (token.kind == Tokenizer::Kind::Word) {
+      auto result = std::from_chars(token.text.data(), token.text.data() + token.text.size(), value);
+      if (result.ec == std::errc() && result.ptr == token.text.data() + token.text.size()) return true;
+    }
+    return Fail("expected an integer");
+  }
+
+  bool ReadBool(bool &value) {
+    auto token = tokenizer_.Next();
+    if (token.kind == Tokenizer::Kind::Word && (token.text == "true" || token.text == "false")) {
+      value = token.text == "true";
+      return true;
+    }
+    return Fail("expected true or false");
+  }
+
+  bool ReadString(std::string &value) {
+    auto token = tokenizer_.Next();
+    if (token.kind != Tokenizer::Kind::String) return Fail("expected a quoted string");
+    value.assign(token.text);
+    return true;
+  }
+
+  /**
+   * @brief Call `field(key)` for each key up to the end of the line, `field` reads the value
+   * and returns false when it does not know the key.
+   *
+   */
+  template <typename Field>
+  bool ReadFields(Field field) {
+    while (true) {
+      auto token = tokenizer_.Next();
+      if (token.kind == Tokenizer::Kind::EndOfLine || token.kind == Tokenizer::Kind::EndOfFile) return true;
+      if (token.kind != Tokenizer::Kind::Word) return Fail("expected a field name");
+      if (!field(token.text)) {
+        if (error.empty()) error = "unknown field '" + std::string(token.text) + "'";
+        return false;
+      }
+    }
+  }
+
+  bool ExpectEndOfLine() {
+    auto token = tokenizer_.Next();
+    if (token.kind == Tokenizer::Kind::EndOfLine || token.kind == Tokenizer::Kind::EndOfFile) return true;
+    return Fail("expected the end of the line");
+  }
+
+  bool SkipLine() {
+    while (true) {
+      auto token = tokenizer_.Next();
+      if (token.kind == Tokenizer::Kind::EndOfLine || token.kind == Tokenizer::Kind::EndOfFile) return true;
+      if (token.kind == Tokenizer::Kind::Error) return Fail(std::string(token.text));
+    }
+  }
+
+  bool Fail(const std::string &reason) {
+    if (error.empty()) error = reason;
+    return false;
+  }
+
+  size_t GetLine() const { return tokenizer_.GetLine(); }
+
+  std::string error;
+
+ private:
+  Tokenizer tokenizer_;
+};
+
+}  // namespace
+
+static const char *rigid_body_type_name(RigidBody2D::Type type) {
+  switch (type) {
+    case RigidBody2D::Type::Static:
+      return "static";
+    case RigidBody2D::Type::Kinematic:
+      return "kinematic";
+    default:
+      return "dynamic";
+  }
+}
+
+bool SceneSerializer::SerializeText(const std::string &path) {
+  entt::registry &registry      = scene_.registry_;
+  auto           &asset_manager = AssetManager::Get();
+
+  TextWriter writer(path);
+  if (!writer.IsGood()) {
+    logger_->error("Failed to open {0} for writing", path);
+    return false;
+  }
+
+  writer.Word("scene").Int(kTextVersion).EndLine();
+
+  registry.view<ID>().each([&](entt::entity entity, ID &id) {
+    writer.Word("entity").Int(static_cast<uint64_t>(id.id)).EndLine();
+
+    if (auto *tag = registry.try_get<Tag>(entity)) {
+      writer.Indent().Word("tag").String(tag->tag).EndLine();
+    }
+    auto *relationship = registry.try_get<Relationship>(entity);
+    if (relationship && relationship->parent != entt::null) {
+      if (auto *parent_id = registry.try_get<ID>(relationship->parent)) {
+        writer.Indent().Word("parent").Int(static_cast<uint64_t>(parent_id->id)).EndLine();
+      }
+    }
+    if (auto *transform = registry.try_get<Transform>(entity)) {
+      writer.Indent().Word("transform");
+      writer.Word("translation").Vec(&transform->translation.x, 3);
+      writer.Word("rotation").Vec(&transform->rotation.x, 3);
+      writer.Word("scale").Vec(&transform->scale.x, 3);
+      writer.EndLine();
+    }
+    if (auto *camera = registry.try_get<Camera2D>(entity)) {
+      writer.Indent().Word("camera");
+      writer.Word("position").Vec(&camera->position.x, 3);
+      writer.Word("rotation").Float(camera->rotation);
+      writer.Word("aspect_ratio").Float(camera->aspect_ratio);
+      writer.Word("zoom_level").Float(camera->zoom_level);
+      writer.Word("primary").Word(camera->primary ? "true" : "false");
+      writer.EndLine();
+    }
+    if (auto *sprite = registry.try_get<Sprite2D>(entity)) {
+      writer.Indent().Word("sprite");
+      writer.Word("color").Vec(&sprite->color.x, 4);
+      const std::string &texture_path = asset_manager.GetPath(sprite->texture);
+      if (!texture_path.empty()) {
+        writer.Word("texture").String(texture_path).Int(static_cast<uint64_t>(asset_manager.GetUUID(sprite->texture)));
+      }
+      writer.Word("tiling").Float(sprite->tiling_factor);
+      writer.Word("layer").Int(sprite->layer);
+      writer.EndLine();
+    }
+    if (auto *animation = registry.try_get<AnimatedSprite2D>(entity)) {
+      writer.Indent().Word("animated_sprite");
+      writer.Word("frames").Int(animation->h_frames).Int(animation->v_frames);
+      writer.Word("frame_time").Float(animation->frame_time);
+      writer.EndLine();
+    }
+    if (auto *body = registry.try_get<RigidBody2D>(entity)) {
+      writer.Indent().Word("rigid_body");
+      writer.Word("type").Word(rigid_body_type_name(body->type));
+      writer.Word("velocity").Vec(&body->velocity.x, 2);
+      writer.Word("mass").Float(body->mass);
+      writer.Word("restitution").Float(body->restitution);
+      writer.Word("gravity_scale").Float(body->gravity_scale);
+      writer.EndLine();
+    }
+    if (auto *aabb = registry.try_get<AABB>(entity)) {
+      writer.Indent().Word("aabb");
+      writer.Word("position").Vec(&aabb->position.x, 3);
+      writer.Word("scale").Vec(&aabb->scale.x, 3);
+      writer.EndLine();
+    }
+    if (auto *circle = registry.try_get<Circle>(entity)) {
+      writer.Indent().Word("circle");
+      writer.Word("position").Vec(&circle->position.x, 3);
+      writer.Word("radius").Float(circle->radius);
+      writer.EndLine();
+    }
+
+    writer.Word("end").EndLine();
+  });
+
+  writer.Flush();
+  if (!writer.IsGood()) {
+    logger_->error("Failed to write {0}", path);
+    return false;
+  }
+  return true;
+}
+
+bool SceneSerializer::DeserializeText(const std::string &path) {
+  using Clock = std::chrono::steady_clock;
+  auto start  = Clock::now();
+
+  MappedFile file;
+  if (!file.Open(path)) {
+    logger_->error("Failed to open {0}", path);
+    return false;
+  }
+
+  scene_.Clear();
+  entt::registry &registry      = scene_.registry_;
+  auto           &asset_manager = AssetManager::Get();
+
+  const char *text = reinterpret_cast<const char *>(file.GetData());
+  TextReader  reader(text, text + file.GetSize());
+
+  // Parents may appear after their children, links are made once every entity exists.
+  std::vector<std::pair<entt::entity, uint64_t>> parents;
+  std::string                                    texture_path;
+  entt::entity                                   entity       = entt::null;
+  size_t                                         entity_count = 0;
+  bool                                           version      = false;
+
+  // One component statement, the fields of the line go into a default constructed component.
+  auto read_component = [&](std::string_view name) -> bool {
+    if (name == "tag") {
+      auto &tag = registry.get_or_emplace<Tag>(entity);
+      return reader.ReadString(tag.tag) && reader.ExpectEndOfLine();
+    }
+    if (name == "parent") {
+      uint64_t parent;
+      if (!reader.ReadInt(parent) || !reader.ExpectEndOfLine()) return false;
+      parents.emplace_back(entity, parent);
+      return true;
+    }
+    if (name == "transform") {
+      Transform transform;
+      bool      ok = reader.ReadFields([&](std::string_view key) {
+        if (key == "translation") return reader.ReadFloats(&transform.translation.x, 3);
+        if (key == "rotation") return reader.ReadFloats(&transform.rotation.x, 3);
+        if (key == "scale") return reader.ReadFloats(&transform.scale.x, 3);
+        return false;
+      });
+      if (ok) registry.emplace_or_replace<Transform>(entity, transform);
+      return ok;
+    }
+    if (name == "camera") {
+      Camera2D camera(glm::vec3(0.0f), 0.0f, 16.0f / 9.0f, 1.0f, false);
+      bool     ok = reader.ReadFields([&](std::string_view key) {
+        if (key == "position") return reader.ReadFloats(&camera.position.x, 3);
+        if (key == "rotation") return reader.ReadFloat(camera.rotation);
+        if (key == "aspect_ratio") return reader.ReadFloat(camera.aspect_ratio);
+        if (key == "zoom_level") return reader.ReadFloat(camera.zoom_level);
+        if (key == "primary") return reader.ReadBool(camera.primary);
+        return false;
+      });
+      if (!ok) return false;
+      camera.SetZoomLevel(camera.zoom_level);
+      registry.emplace_or_replace<Camera2D>(entity, camera);
+      return true;
+    }
+    if (name == "sprite") {
+      Sprite2D sprite;
+      bool     ok = reader.ReadFields([&](std::string_view key) {
+        if (key == "color") return reader.ReadFloats(&sprite.color.x, 4);
+        if (key == "tiling") return reader.ReadFloat(sprite.tiling_factor);
+        if (key == "layer") return reader.ReadInt(sprite.layer);
+        if (key == "texture") {
+          uint64_t uuid;
+          if (!reader.ReadString(texture_path) || !reader.ReadInt(uuid)) return false;
+          asset_manager.Release(sprite.texture);
+          sprite.texture = get_texture(texture_path, UUID(uuid));
+          return true;
+        }
+        return false;
+      });
+      if (!ok) {
+        asset_manager.Release(sprite.texture);
+        return false;
+      }
+      // A second sprite line replaces the first, the destroy signal releases its texture.
+      registry.remove<Sprite2D>(entity);
+      registry.emplace<Sprite2D>(entity, sprite);
+      return true;
+    }
+    if (name == "animated_sprite") {
+      AnimatedSprite2D animation;
+      bool             ok = reader.ReadFields([&](std::string_view key) {
+        if (key == "frames") return reader.ReadInt(animation.h_frames) && reader.ReadInt(animation.v_frames);
+        if (key == "frame_time") return reader.ReadFloat(animation.frame_time);
+        return false;
+      });
+      if (ok) registry.emplace_or_replace<AnimatedSprite2D>(entity, animation);
+      return ok;
+    }
+    if (name == "rigid_body") {
+      RigidBody2D body;
+      bool        ok = reader.ReadFields([&](std::string_view key) {
+        if (key == "type") {
+          auto token = reader.Next();
+          if (token.text == "static") {
+            body.type = RigidBody2D::Type::Static;
+          } else if (token.text == "kinematic") {
+            body.type = RigidBody2D::Type::Kinematic;
+          } else if (token.text == "dynamic") {
+            body.type = RigidBody2D::Type::Dynamic;
+          } else {
+            return reader.Fail("expected static, kinematic or dynamic");
+          }
+          return true;
+        }
+        if (key == "velocity") return reader.ReadFloats(&body.velocity.x, 2);
+        if (key == "mass") return reader.ReadFloat(body.mass);
+        if (key == "restitution") return reader.ReadFloat(body.restitution);
+        if (key == "gravity_scale") return reader.ReadFloat(body.gravity_scale);
+        return false;
+      });
+      if (ok) registry.emplace_or_replace<RigidBody2D>(entity, body);
+      return ok;
+    }
+    if (name == "aabb") {
+      AABB aabb;
+      bool ok = reader.ReadFields([&](std::string_view key) {
+        if (key == "position") return reader.ReadFloats(&aabb.position.x, 3);
+        if (key == "scale") return reader.ReadFloats(&aabb.scale.x, 3);
+        return false;
+      });
+      if (ok) registry.emplace_or_replace<AABB>(entity, aabb);
+      return ok;
+    }
+    if (name == "circle") {
+      Circle circle;
+      bool   ok = reader.ReadFields([&](std::string_view key) {
+        if (key == "position") return reader.ReadFloats(&circle.position.x, 3);
+        if (key == "radius") return reader.ReadFloat(circle.radius);
+        return false;
+      });
+      if (ok) registry.emplace_or_replace<Circle>(entity, circle);
+      return ok;
+    }
+
+    // Written by a newer build, keep the rest of the entity.
+    logger_->warn("{0}:{1}: skipping unknown component '{2}'", path, reader.GetLine(), std::string(name));
+    return reader.SkipLine();
+  };
+
+  bool ok = true;
+  while (ok) {
+    auto token = reader.Next();
+    if (token.kind == Tokenizer::Kind::EndOfFile) break;
+    if (token.kind == Tokenizer::Kind::EndOfLine) continue;
+    if (token.kind != Tokenizer::Kind::Word) {
+      ok = reader.Fail(token.kind == Tokenizer::Kind::Error ? std::string(token.text) : "expected a statement");
+      break;
+    }
+
+    if (token.text == "scene") {
+      uint32_t file_version = 0;
+      ok                    = reader.ReadInt(file_version) && reader.ExpectEndOfLine();
+      if (ok && file_version != kTextVersion) {
+        ok = reader.Fail("scene format version " + std::to_string(file_version) + ", expected " +
+                         std::to_string(kTextVersion));
+      }
+      version = true;
+    } else if (!version) {
+      ok = reader.Fail("missing 'scene <version>' header");
+    } else if (token.text == "entity") {
+      if (entity != entt::null) {
+        ok = reader.Fail("'entity' inside an entity, missing 'end'");
+        break;
+      }
+      uint64_t uuid;
+      ok = reader.ReadInt(uuid) && reader.ExpectEndOfLine();
+      if (!ok) break;
+      entity = scene_.CreateEntityWithUUID(UUID(uuid), "").GetHandle();
+      entity_count++;
+    } else if (token.text == "end") {
+      ok     = entity != entt::null ? reader.ExpectEndOfLine() : reader.Fail("'end' outside an entity");
+      entity = entt::null;
+    } else if (entity != entt::null) {
+      ok = read_component(token.text);
+    } else {
+      ok = reader.Fail("unexpected '" + std::string(token.text) + "' outside an entity");
+    }
+  }
+  if (ok && entity != entt::null) ok = reader.Fail("missing 'end' at the end of the file");
+
+  if (!ok) {
+    logger_->error("{0}:{1}: {2}", path, reader.GetLine(), reader.error);
+    scene_.Clear();
+    return false;
+  }
+
+  // Links are made in place rather than through SetParent(), which walks and allocates once per child.
+  // In reverse, each child goes first among its siblings, so they end up in file order.
+  for (auto it = parents.rbegin(); it != parents.rend(); ++it) {
+    entt::entity child        = it->first;
+    entt::entity parent       = scene_.FindEntityByUUID(UUID(it->second)).GetHandle();
+    auto        &relationship = registry.get<Relationship>(child);
+    // Of several parent lines the last one wins.
+    if (relationship.parent != entt::null) continue;
+    if (parent == entt::null) {
+      logger_->warn("{0}: parent {1} does not exist, entity left at the root", path, it->second);
+      continue;
+    }
+
+    bool cycle = false;
+    for (auto ancestor = parent; ancestor != entt::null && !cycle;
+         ancestor      = registry.get<Relationship>(ancestor).parent) {
+      cycle = ancestor == child;
+    }
+    if (cycle) {
+      logger_->warn("{0}: parent {1} is a descendant of its child, entity left at the root", path, it->second);
+      continue;
+    }
+
+    auto &parent_relationship = registry.get<Relationship>(parent);
+    relationship.parent       = parent;
+    relationship.next_sibling = parent_relationship.first_child;
+    if (parent_relationship.first_child != entt::null) {
+      registry.get<Relationship>(parent_relationship.first_child).prev_sibling = child;
+    }
+    parent_relationship.first_child = child;
+    parent_relationship.children++;
+  }
+
+  // Depths in one walk down from the roots, sharing a single stack.
+  if (!parents.empty()) {
+    std::vector<entt::entity> stack;
+    for (auto root : registry.view<Relationship>()) {
+      const auto &relationship = registry.get<Relationship>(root);
+      if (relationship.parent == entt::null && relationship.first_child != entt::null) stack.push_back(root);
+    }
+    while (!stack.empty()) {
+      auto e = stack.back();
+      stack.pop_back();
+
+      uint32_t depth = registry.get<Relationship>(e).depth + 1;
+      for (auto c = registry.get<Relationship>(e).first_child; c != entt::null;
+           c      = registry.get<Relationship>(c).next_sibling) {
+        registry.get<Relationship>(c).depth = depth;
+        stack.push_back(c);
+      }
+    }
+    scene_.hierarchy_changed_ = true;
+  }
+
+  float ms = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+  logger_->info("Loaded {0} entities from {1} in {2:.1f} ms ({3:.1f} MB/s)", entity_count, path, ms,
+                file.GetSize() / (1024.0f * 1024.0f) / (ms / 1000.0f));
+  return true;
+}
+
+bool SceneSerializer::IsTextPath(const std::string &path) {
+  static constexpr std::string_view kTextExtension = ".scene";
+  return path.size() >= kTextExtension.size() &&
+         path.compare(path.size() - kTextExtension.size(), kTextExtension.size(), kTextExtension) == 0;
+}
+
+bool SceneSerializer::IsBinaryFile(const std::string &path) {
+  std::ifstream stream(path, std::ios::binary);
+  char          magic[sizeof(kBinaryMagic)] = {};
+  stream.read(magic, sizeof(magic));
+  return stream.gcount() == sizeof(magic) && std::memcmp(magic, kBinaryMagic, sizeof(magic)) == 0;
+}
+
+}  // namespace MEngine
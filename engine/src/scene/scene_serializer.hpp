@@ -0,0 +1,106 @@
+/**
+ * @file scene_serializer.hpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2024-08-21
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "core/logger.hpp"
+#include "core/uuid.hpp"
+#include "render/texture.hpp"
+
+namespace MEngine {
+
+class Scene;
+
+/**
+ * @brief Reads and writes the entities of a Scene.
+ *
+ * Scenes are stored in a binary form that loads fast and a text form that diffs
+ * well. Files identify entities by their ID component, so references between entities
+ * (the hierarchy) survive a round trip even though entt handles do not. Derived
+ * state (WorldTransform, the spatial index) is not stored and rebuilt on load.
+ *
+ */
+class SceneSerializer {
+ public:
+  /**
+   * @brief What the readers do with the texture of a sprite.
+   *
+   */
+  enum class TextureMode {
+    // Queue the file for decoding, for scenes that are drawn.
+    Load,
+    // Only keep the path and UUID, for tools that write the scene back without drawing it.
+    PathOnly,
+  };
+
+  explicit SceneSerializer(Scene &scene);
+
+  void SetTextureMode(TextureMode mode) { texture_mode_ = mode; }
+
+  /**
+   * @brief Write every entity that has an ID as a binary scene: a UUID table followed
+   * by one contiguous chunk per component pool.
+   *
+   */
+  bool SerializeBinary(const std::string &path);
+
+  /**
+   * @brief Replace the content of the scene with a binary scene file. The file is
+   * memory mapped and every pool is filled with a single range insert straight from
+   * the mapping, plain data components are not parsed field by field.
+   *
+   */
+  bool DeserializeBinary(const std::string &path);
+
+  /**
+   * @brief Write every entity that has an ID as text, one component per line, for
+   * scenes kept under version control.
+   *
+   */
+  bool SerializeText(const std::string &path);
+
+  /**
+   * @brief Replace the content of the scene with a text scene file. A single pass
+   * tokenizer walks the mapped file and entities are created as they are read,
+   * without building a document tree first.
+   *
+   */
+  bool DeserializeText(const std::string &path);
+
+  /**
+   * @brief Whether `path` starts with the magic of a binary scene.
+   *
+   */
+  static bool IsBinaryFile(const std::string &path);
+
+  /**
+   * @brief Whether `path` names a text scene, i.e. ends in `.scene`.
+   *
+   */
+  static bool IsTextPath(const std::string &path);
+
+ private:
+  /**
+   * @brief Handle of the texture a scene file names, loaded or only referenced by `texture_mode_`.
+   *
+   */
+  TextureHandle get_texture(const std::string &path, UUID uuid) const;
+
+  Scene      &scene_;
+  TextureMode texture_mode_ = TextureMode::Load;
+
+  std::shared_ptr<spdlog::logger> logger_;
+};
+
+}  // namespace MEngine
@@ -0,0 +1,110 @@
+#include "scene/simulation_thread.hpp"
+
+#include <algorithm>
+
+#include "scene/scene.hpp"
+
+namespace MEngine {
+
+SimulationThread::SimulationThread() { logger_ = Logger::Get("SimulationThread"); }
+
+SimulationThread::~SimulationThread() { Stop(); }
+
+void SimulationThread::Start(std::shared_ptr<Scene> scene, float tick_rate) {
+  if (IsRunning()) Stop();
+
+  scene_           = std::move(scene);
+  tick_duration_   = 1.0f / std::max(tick_rate, 1.0f);
+  start_time_      = Clock::now();
+  last_drawn_tick_ = 0;
+  snapshots_.Reset();
+
+  ticks_        = 0;
+  late_ticks_   = 0;
+  tick_ms_      = 0.0f;
+  max_tick_ms_  = 0.0f;
+  frames_drawn_ = 0;
+  repeated_     = 0;
+
+  running_ = true;
+  thread_  = std::thread(&SimulationThread::loop, this);
+  logger_->info("Simulation thread started at {} ticks per second", tick_rate);
+}
+
+void SimulationThread::Stop() {
+  if (!IsRunning()) return;
+
+  running_ = false;
+  thread_.join();
+  logger_->info("Simulation thread stopped after {} ticks ({} late)", ticks_.load(), late_ticks_.load());
+}
+
+void SimulationThread::SetViewportSize(int width, int height) {
+  viewport_width_.store(std::max(width, 1), std::memory_order_relaxed);
+  viewport_height_.store(std::max(height, 1), std::memory_order_relaxed);
+}
+
+double SimulationThread::seconds_since_start() const {
+  return std::chrono::duration<double>(Clock::now() - start_time_).count();
+}
+
+void SimulationThread::loop() {
+  const auto tick = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(tick_duration_));
+
+  auto next_tick = Clock::now();
+  while (running_.load(std::memory_order_relaxed)) {
+    std::this_thread::sleep_until(next_tick);
+
+    auto start = Clock::now();
+    scene_->Tick(tick_duration_);
+
+    RenderSnapshot &snapshot = snapshots_.GetWriteBuffer();
+    scene_->BuildSnapshot(snapshot, viewport_width_.load(std::memory_order_relaxed),
+                          viewport_height_.load(std::memory_order_relaxed));
+    snapshot.time = seconds_since_start();
+    snapshots_.Publish();
+
+    float tick_ms = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    tick_ms_.store(tick_ms, std::memory_order_relaxed);
+    max_tick_ms_.store(std::max(max_tick_ms_.load(std::memory_order_relaxed), tick_ms), std::memory_order_relaxed);
+    ticks_.fetch_add(1, std::memory_order_relaxed);
+
+    // Always simulate tick_duration_ per tick. When a tick overran by more than a whole tick,
+    // restart the schedule from now instead of running the missed ticks back to back.
+    next_tick += tick;
+    auto now = Clock::now();
+    if (now > next_tick + tick) {
+      late_ticks_.fetch_add(1, std::memory_order_relaxed);
+      next_tick = now;
+    }
+  }
+}
+
+bool SimulationThread::Draw() {
+  const RenderSnapshot *snapshot = snapshots_.Acquire();
+  if (!snapshot) return false;
+
+  if (snapshot->tick == last_drawn_tick_) repeated_.fetch_add(1, std::memory_order_relaxed);
+  last_drawn_tick_ = snapshot->tick;
+
+  // Drawn one tick in the past: `current` was published at snapshot->time, `previous`
+  // one tick before it. A late tick clamps at the newest state instead of extrapolating.
+  float alpha = static_cast<float>((seconds_since_start() - snapshot->time) / tick_duration_);
+  scene_->DrawSnapshot(*snapshot, std::clamp(alpha, 0.0f, 1.0f));
+
+  frames_drawn_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+SimulationThread::Statistics SimulationThread::GetStats() const {
+  Statistics stats;
+  stats.ticks        = ticks_.load(std::memory_order_relaxed);
+  stats.late_ticks   = late_ticks_.load(std::memory_order_relaxed);
+  stats.tick_ms      = tick_ms_.load(std::memory_order_relaxed);
+  stats.max_tick_ms  = max_tick_ms_.load(std::memory_order_relaxed);
+  stats.frames_drawn = frames_drawn_.load(std::memory_order_relaxed);
+  stats.repeated     = repeated_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace MEngine
@@ -0,0 +1,117 @@
+/**
+ * @file simulation_thread.hpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2024-08-20
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "core/logger.hpp"
+#include "core/triple_buffer.hpp"
+#include "scene/render_snapshot.hpp"
+
+namespace MEngine {
+
+class Scene;
+
+/**
+ * @brief Ticks a Scene on its own thread at a fixed rate, decoupled from presentation.
+ *
+ * After every tick the thread publishes a RenderSnapshot into a triple buffer.
+ * Draw(), called by the GL thread each frame, takes the newest snapshot and
+ * blends it with the tick before, one tick behind real time, so motion stays
+ * smooth at any frame rate and a slow tick never blocks a frame.
+ *
+ * While it runs the scene belongs to the simulation thread: the GL thread must
+ * not touch its components, and the systems run by Scene::Tick() must not load
+ * textures or make GL calls.
+ *
+ */
+class SimulationThread {
+ public:
+  struct Statistics {
+    uint64_t ticks        = 0;
+    uint64_t late_ticks   = 0;  // ticks that started over a full tick late, the backlog is dropped
+    float    tick_ms      = 0.0f;
+    float    max_tick_ms  = 0.0f;
+    uint64_t frames_drawn = 0;
+    uint64_t repeated     = 0;  // frames drawn without a new snapshot since the last one
+  };
+
+  SimulationThread();
+  ~SimulationThread();
+
+  /**
+   * @brief Start ticking `scene` `tick_rate` times per second.
+   *
+   */
+  void Start(std::shared_ptr<Scene> scene, float tick_rate = 60.0f);
+
+  /**
+   * @brief Finish the current tick and join the thread, the scene is the caller's again afterwards.
+   *
+   */
+  void Stop();
+
+  bool IsRunning() const { return thread_.joinable(); }
+
+  /**
+   * @brief Size the runtime camera uses for its aspect ratio, picked up by the next tick.
+   *
+   */
+  void SetViewportSize(int width, int height);
+
+  /**
+   * @brief Draw the newest snapshot interpolated to the current time. GL thread only,
+   * returns false until the first tick has been published.
+   *
+   */
+  bool Draw();
+
+  Statistics GetStats() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  void loop();
+
+  double seconds_since_start() const;
+
+  std::shared_ptr<Scene> scene_;
+  std::thread            thread_;
+  std::atomic<bool>      running_{false};
+
+  float tick_duration_ = 1.0f / 60.0f;
+
+  Clock::time_point start_time_;
+
+  std::atomic<int> viewport_width_{1280};
+  std::atomic<int> viewport_height_{720};
+
+  TripleBuffer<RenderSnapshot> snapshots_;
+  uint64_t                     last_drawn_tick_ = 0;  // GL thread only
+
+  // Written by the simulation thread, read by GetStats().
+  std::atomic<uint64_t> ticks_{0};
+  std::atomic<uint64_t> late_ticks_{0};
+  std::atomic<float>    tick_ms_{0.0f};
+  std::atomic<float>    max_tick_ms_{0.0f};
+
+  // Written by the GL thread.
+  std::atomic<uint64_t> frames_drawn_{0};
+  std::atomic<uint64_t> repeated_{0};
+
+  std::shared_ptr<spdlog::logger> logger_;
+};
+
+}  // namespace MEngine
@@ -0,0 +1,185 @@
+#include "scene/spatial_index.hpp"
+
+#include <cmath>
+
+namespace MEngine {
+
+SpatialIndex::SpatialIndex(float cell_size) : cell_size_(cell_size), inv_cell_size_(1.0f / cell_size) {}
+
+/**
+ * @brief floor(`value`) clamped to [-`limit`, `limit`] before the cast, which is undefined for values
+ * out of the int range and for NaN. NaN goes to -`limit`.
+ *
+ */
+static int to_coordinate(float value, int limit) {
+  float cell = std::floor(value);
+  if (!(cell > static_cast<float>(-limit))) return -limit;
+  if (cell > static_cast<float>(limit)) return limit;
+  return static_cast<int>(cell);
+}
+
+glm::ivec2 SpatialIndex::to_cell(const glm::vec2 &point) const {
+  return {to_coordinate(point.x * inv_cell_size_, kMaxCellCoordinate),
+          to_coordinate(point.y * inv_cell_size_, kMaxCellCoordinate)};
+}
+
+SpatialIndex::CellRange SpatialIndex::to_range(const Bounds2D &bounds) const {
+  return {to_cell(bounds.min), to_cell(bounds.max)};
+}
+
+void SpatialIndex::add_to_cells(entt::entity entity, const Entry &entry) {
+  if (entry.oversized) {
+    oversized_.push_back({entity, entry.bounds});
+    return;
+  }
+
+  for (int y = entry.range.min.y; y <= entry.range.max.y; y++) {
+    for (int x = entry.range.min.x; x <= entry.range.max.x; x++) {
+      cells_[pack(x, y)].push_back({entity, entry.bounds});
+    }
+  }
+}
+
+void SpatialIndex::remove_from_cells(entt::entity entity, const Entry &entry) {
+  if (entry.oversized) {
+    for (size_t i = 0; i < oversized_.size(); i++) {
+      if (oversized_[i].entity != entity) continue;
+      oversized_[i] = oversized_.back();
+      oversized_.pop_back();
+      break;
+    }
+    return;
+  }
+
+  for (int y = entry.range.min.y; y <= entry.range.max.y; y++) {
+    for (int x = entry.range.min.x; x <= entry.range.max.x; x++) {
+      auto cell = cells_.find(pack(x, y));
+      if (cell == cells_.end()) continue;
+
+      auto &items = cell->second;
+      for (size_t i = 0; i < items.size(); i++) {
+        if (items[i].entity != entity) continue;
+        items[i] = items.back();
+        items.pop_back();
+        break;
+      }
+      if (items.empty()) cells_.erase(cell);
+    }
+  }
+}
+
+void SpatialIndex::Update(entt::entity entity, const Bounds2D &bounds) {
+  CellRange range     = to_range(bounds);
+  bool      oversized = is_oversized(range);
+
+  auto it = entries_.find(entity);
+  if (it == entries_.end()) {
+    Entry entry{bounds, range, oversized};
+    add_to_cells(entity, entry);
+    entries_.emplace(entity, entry);
+    return;
+  }
+
+  Entry &entry = it->second;
+  if (oversized && entry.oversized) {
+    entry.bounds = bounds;
+    entry.range  = range;
+    for (auto &item : oversized_) {
+      if (item.entity == entity) {
+        item.bounds = bounds;
+        break;
+      }
+    }
+    return;
+  }
+
+  if (!oversized && !entry.oversized && entry.range == range) {
+    if (entry.bounds.min == bounds.min && entry.bounds.max == bounds.max) return;
+
+    // Same cells, only the bounds stored next to the entity change.
+    entry.bounds = bounds;
+    for (int y = range.min.y; y <= range.max.y; y++) {
+      for (int x = range.min.x; x <= range.max.x; x++) {
+        for (auto &item : cells_[pack(x, y)]) {
+          if (item.entity == entity) {
+            item.bounds = bounds;
+            break;
+          }
+        }
+      }
+    }
+    return;
+  }
+
+  remove_from_cells(entity, entry);
+  entry = Entry{bounds, range, oversized};
+  add_to_cells(entity, entry);
+}
+
+void SpatialIndex::Remove(entt::entity entity) {
+  auto it = entries_.find(entity);
+  if (it == entries_.end()) return;
+  remove_from_cells(entity, it->second);
+  entries_.erase(it);
+}
+
+void SpatialIndex::Clear() {
+  cells_.clear();
+  entries_.clear();
+  oversized_.clear();
+}
+
+void SpatialIndex::Query(const Bounds2D &bounds, std::vector<entt::entity> &result) const {
+  for (const auto &item : oversized_) {
+    if (item.bounds.Overlaps(bounds)) result.push_back(item.entity);
+  }
+
+  CellRange range = to_range(bounds);
+
+  // Walk whichever is smaller: the cells under the query or the occupied cells.
+  const uint64_t range_cells =
+      static_cast<uint64_t>(range.max.x - range.min.x + 1) * static_cast<uint64_t>(range.max.y - range.min.y + 1);
+
+  auto visit = [&](const glm::ivec2 &cell, const std::vector<Item> &items) {
+    for (const auto &item : items) {
+      if (!item.bounds.Overlaps(bounds)) continue;
+      // An entity spanning several cells is reported by the first cell shared with the query.
+      if (to_cell(glm::max(item.bounds.min, bounds.min)) != cell) continue;
+      result.push_back(item.entity);
+    }
+  };
+
+  if (range_cells > cells_.size()) {
+    for (const auto &[key, items] : cells_) {
+      glm::ivec2 cell = unpack(key);
+      if (cell.x < range.min.x || cell.x > range.max.x || cell.y < range.min.y || cell.y > range.max.y) continue;
+      visit(cell, items);
+    }
+    return;
+  }
+
+  for (int y = range.min.y; y <= range.max.y; y++) {
+    for (int x = range.min.x; x <= range.max.x; x++) {
+      auto cell = cells_.find(pack(x, y));
+      if (cell == cells_.end()) continue;
+      visit({x, y}, cell->second);
+    }
+  }
+}
+
+void SpatialIndex::Query(const glm::vec2 &point, std::vector<entt::entity> &result) const {
+  for (const auto &item : oversized_) {
+    if (item.bounds.Contains(point)) result.push_back(item.entity);
+  }
+
+  glm::ivec2 cell = to_cell(point);
+
+  auto it = cells_.find(pack(cell.x, cell.y));
+  if (it == cells_.end()) return;
+
+  for (const auto &item : it->second) {
+    if (item.bounds.Contains(point)) result.push_back(item.entity);
+  }
+}
+
+}  // namespace MEngine
@@ -0,0 +1,154 @@
+/**
+ * @file spatial_index.hpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief
+ * @version 0.1
+ * @date 2024-08-08
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+#include "scene/bounds.hpp"
+
+namespace MEngine {
+
+/**
+ * @brief Uniform hash grid over entity bounds.
+ *
+ * Only occupied cells are stored, so the world may be unbounded. An entity is
+ * listed in every cell its bounds touch; moving it inside the same cells only
+ * rewrites the stored bounds. Entities that would touch more than
+ * kMaxCellsPerEntity cells (e.g. a scaled up background) are kept in a separate
+ * list that every query scans, instead of being copied into all of them.
+ *
+ */
+class SpatialIndex {
+ public:
+  /**
+   * @param cell_size Edge length of a cell in world units, ideally a few times the typical entity size.
+   */
+  explicit SpatialIndex(float cell_size = 4.0f);
+  ~SpatialIndex() = default;
+
+  /**
+   * @brief Insert `entity` or move it to `bounds`.
+   *
+   */
+  void Update(entt::entity entity, const Bounds2D &bounds);
+
+  void Remove(entt::entity entity);
+
+  void Clear();
+
+  bool Contains(entt::entity entity) const { return entries_.find(entity) != entries_.end(); }
+
+  size_t Size() const { return entries_.size(); }
+
+  /**
+   * @brief Append every entity whose bounds overlap `bounds` to `result`, each at most once.
+   *
+   */
+  void Query(const Bounds2D &bounds, std::vector<entt::entity> &result) const;
+
+  /**
+   * @brief Append every entity whose bounds contain `point` to `result`.
+   *
+   */
+  void Query(const glm::vec2 &point, std::vector<entt::entity> &result) const;
+
+  /**
+   * @brief Call `callback(a, b)` once for every pair of entities whose bounds overlap.
+   *
+   */
+  template <typename Callback>
+  void ForEachOverlappingPair(Callback callback) const {
+    // Oversized entities are in no cell, each is tested against every other entity once.
+    for (size_t i = 0; i < oversized_.size(); i++) {
+      for (size_t j = i + 1; j < oversized_.size(); j++) {
+        if (oversized_[i].bounds.Overlaps(oversized_[j].bounds)) callback(oversized_[i].entity, oversized_[j].entity);
+      }
+      for (const auto &[entity, entry] : entries_) {
+        if (!entry.oversized && oversized_[i].bounds.Overlaps(entry.bounds)) callback(oversized_[i].entity, entity);
+      }
+    }
+
+    for (const auto &[key, items] : cells_) {
+      glm::ivec2 cell = unpack(key);
+      for (size_t i = 0; i < items.size(); i++) {
+        for (size_t j = i + 1; j < items.size(); j++) {
+          if (!items[i].bounds.Overlaps(items[j].bounds)) continue;
+          // A pair sharing several cells is reported by the first shared cell only.
+          Bounds2D overlap(glm::max(items[i].bounds.min, items[j].bounds.min),
+                           glm::min(items[i].bounds.max, items[j].bounds.max));
+          if (to_cell(overlap.min) != cell) continue;
+          callback(items[i].entity, items[j].entity);
+        }
+      }
+    }
+  }
+
+  float GetCellSize() const { return cell_size_; }
+
+ private:
+  static constexpr uint64_t kMaxCellsPerEntity = 16;
+
+  // Cell coordinates are clamped to this range, far beyond any real scene but safe to cast and multiply.
+  static constexpr int kMaxCellCoordinate = 1 << 24;
+
+  struct Item {
+    entt::entity entity;
+    Bounds2D     bounds;
+  };
+
+  struct CellRange {
+    glm::ivec2 min;
+    glm::ivec2 max;
+
+    bool operator==(const CellRange &other) const { return min == other.min && max == other.max; }
+  };
+
+  struct Entry {
+    Bounds2D  bounds;
+    CellRange range;
+    bool      oversized = false;
+  };
+
+  glm::ivec2 to_cell(const glm::vec2 &point) const;
+
+  CellRange to_range(const Bounds2D &bounds) const;
+
+  static bool is_oversized(const CellRange &range) {
+    return static_cast<uint64_t>(range.max.x - range.min.x + 1) * static_cast<uint64_t>(range.max.y - range.min.y + 1) >
+           kMaxCellsPerEntity;
+  }
+
+  static uint64_t pack(int x, int y) { return (uint64_t)(uint32_t)x << 32 | (uint32_t)y; }
+
+  static glm::ivec2 unpack(uint64_t key) { return {(int32_t)(uint32_t)(key >> 32), (int32_t)(uint32_t)key}; }
+
+  /**
+   * @brief List `entity` in the cells of `entry`, or in the oversized list.
+   *
+   */
+  void add_to_cells(entt::entity entity, const Entry &entry);
+
+  void remove_from_cells(entt::entity entity, const Entry &entry);
+
+  float cell_size_;
+  float inv_cell_size_;
+
+  std::unordered_map<uint64_t, std::vector<Item>> cells_;
+  std::unordered_map<entt::entity, Entry>         entries_;
+  std::vector<Item>                               oversized_;
+};
+
+}  // namespace MEngine
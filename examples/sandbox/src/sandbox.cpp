@@ -1,11 +1,62 @@
 #include "sandbox.hpp"
 
+#include <GLFW/glfw3.h>
+
+#include <cstdlib>
+#include <cstring>
+
+#include "scene/component.hpp"
+
 Sandbox::Sandbox() {}
 
-Sandbox::~Sandbox() {}
+Sandbox::~Sandbox() { StopSimulationThread(); }
+
+void Sandbox::Initialize() {
+  create_demo_scene();
+
+  const char *threaded = std::getenv("MENGINE_THREADED_SIMULATION");
+  threaded_simulation_ = !threaded || std::strcmp(threaded, "0") != 0;
+  // Run() draws the snapshots of the thread, OnUpdate() has nothing left to do.
+  if (threaded_simulation_) StartSimulationThread(active_scene_);
+}
+
+void Sandbox::OnUpdate(float dt) {
+  if (threaded_simulation_) return;
+
+  int width, height;
+  glfwGetFramebufferSize(window_, &width, &height);
+  active_scene_->OnUpdateRuntime(dt, width, height);
+}
+
+void Sandbox::create_demo_scene() {
+  active_scene_ = std::make_shared<Scene>();
+
+  Entity camera = active_scene_->CreateEntity("Camera");
+  camera.AddComponent<Transform>();
+  camera.AddComponent<Camera2D>(-1.0f, 1.0f, -1.0f, 1.0f, 8.0f, true);
+
+  Entity ground           = active_scene_->CreateEntity("Ground");
+  auto  &ground_transform = ground.AddComponent<Transform>(glm::vec3(0.0f, -6.0f, 0.0f));
+  ground_transform.scale  = glm::vec3(16.0f, 1.0f, 1.0f);
+  ground.AddComponent<Sprite2D>(glm::vec4(0.3f, 0.3f, 0.3f, 1.0f));
+  ground.AddComponent<AABB>(ground_transform.translation, ground_transform.scale);
+  ground.AddComponent<RigidBody2D>().type = RigidBody2D::Type::Static;
 
-void Sandbox::Initialize() {}
+  const int columns = 16;
+  const int rows    = 12;
+  for (int row = 0; row < rows; row++) {
+    for (int column = 0; column < columns; column++) {
+      glm::vec3 position(-6.0f + column * 0.8f + (row % 2) * 0.2f, -3.0f + row * 0.8f, 0.0f);
+      glm::vec3 scale(0.5f, 0.5f, 1.0f);
 
-void Sandbox::OnUpdate(float dt) {}
+      Entity box       = active_scene_->CreateEntity("Box");
+      auto  &transform = box.AddComponent<Transform>(position);
+      transform.scale  = scale;
+      box.AddComponent<Sprite2D>(glm::vec4(0.2f + 0.8f * column / columns, 0.2f + 0.8f * row / rows, 0.6f, 1.0f));
+      box.AddComponent<AABB>(position, scale);
+      box.AddComponent<RigidBody2D>().restitution = 0.2f;
+    }
+  }
+}
 
 Application *CreateApplication() { return new Sandbox(); }
@@ -39,6 +39,12 @@ class Sandbox : public Application {
   void DisplayAddComponentEntry(const std::string &entryName);
 
  private:
+  /**
+   * @brief A ground and a stack of falling boxes, enough for the physics and sprite paths to have work.
+   *
+   */
+  void create_demo_scene();
+
   enum class GameMode { Play, Edit };
 
   int  viewport_width_   = 1280;
@@ -49,5 +55,8 @@ class Sandbox : public Application {
 
   std::shared_ptr<Scene> active_scene_;
 
+  // Tick the scene on the SimulationThread, MENGINE_THREADED_SIMULATION=0 ticks it in OnUpdate instead.
+  bool threaded_simulation_ = true;
+
   std::shared_ptr<FrameBuffer> frame_buffer_;
 };
\ No newline at end of file
@@ -0,0 +1,54 @@
+/**
+ * @file scene_converter.cpp
+ * @author MiaoHN (582418227@qq.com)
+ * @brief Converts scene files between the text and the binary format.
+ * @version 0.1
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <cstdio>
+#include <string>
+
+#include "scene/scene.hpp"
+#include "scene/scene_serializer.hpp"
+
+using namespace MEngine;
+
+static void print_usage() {
+  std::printf("usage: scene_converter <input> <output>\n\n"
+              "The input format is detected from the file content. The output is written as\n"
+              "text when its name ends in .scene and as binary otherwise (e.g. .mscene).\n");
+}
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    print_usage();
+    return 1;
+  }
+
+  std::string input  = argv[1];
+  std::string output = argv[2];
+
+  // No GL context is needed: sprite textures only keep their path and UUID, no file is decoded.
+  Scene           scene;
+  SceneSerializer serializer(scene);
+  serializer.SetTextureMode(SceneSerializer::TextureMode::PathOnly);
+  bool loaded = SceneSerializer::IsBinaryFile(input) ? serializer.DeserializeBinary(input)
+                                                     : serializer.DeserializeText(input);
+  if (!loaded) {
+    std::fprintf(stderr, "failed to read %s\n", input.c_str());
+    return 1;
+  }
+  if (!scene.SaveScene(output)) {
+    std::fprintf(stderr, "failed to write %s\n", output.c_str());
+    return 1;
+  }
+
+  std::printf("%s (%s) -> %s (%s), %zu entities\n", input.c_str(),
+              SceneSerializer::IsBinaryFile(input) ? "binary" : "text", output.c_str(),
+              SceneSerializer::IsTextPath(output) ? "text" : "binary", scene.GetEntityCount());
+  return 0;
+}